@@ -0,0 +1,284 @@
+#include "bitmap.h"
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include "memory_usage.h"
+
+static const size_t CONTAINER_WORDS = 1024;
+
+bool RoaringBitmap::Container::contains(uint16_t low) const {
+    if (dense()) {
+        return (words[low >> 6] >> (low & 63)) & 1;
+    }
+    return std::binary_search(array.begin(), array.end(), low);
+}
+
+void RoaringBitmap::Container::add(uint16_t low) {
+    if (dense()) {
+        uint64_t bit = uint64_t(1) << (low & 63);
+        if (!(words[low >> 6] & bit)) {
+            words[low >> 6] |= bit;
+            ++cardinality;
+        }
+        return;
+    }
+    //      ,     
+    if (array.empty() || array.back() < low) {
+        array.push_back(low);
+    }
+    else {
+        auto it = std::lower_bound(array.begin(), array.end(), low);
+        if (*it == low) {
+            return;
+        }
+        array.insert(it, low);
+    }
+    ++cardinality;
+    if (cardinality > ARRAY_LIMIT) {
+        normalize();
+    }
+}
+
+void RoaringBitmap::Container::remove(uint16_t low) {
+    if (dense()) {
+        uint64_t bit = uint64_t(1) << (low & 63);
+        if (words[low >> 6] & bit) {
+            words[low >> 6] &= ~bit;
+            --cardinality;
+            normalize();
+        }
+        return;
+    }
+    auto it = std::lower_bound(array.begin(), array.end(), low);
+    if (it != array.end() && *it == low) {
+        array.erase(it);
+        --cardinality;
+    }
+}
+
+std::vector<uint64_t> RoaringBitmap::Container::as_words() const {
+    if (dense()) {
+        return words;
+    }
+    std::vector<uint64_t> result(CONTAINER_WORDS, 0);
+    for (uint16_t low : array) {
+        result[low >> 6] |= uint64_t(1) << (low & 63);
+    }
+    return result;
+}
+
+void RoaringBitmap::Container::normalize() {
+    if (cardinality > ARRAY_LIMIT && !dense()) {
+        words = as_words();
+        array.clear();
+        array.shrink_to_fit();
+    }
+    else if (cardinality <= ARRAY_LIMIT && dense()) {
+        array.clear();
+        array.reserve(cardinality);
+        for (size_t w = 0; w < CONTAINER_WORDS; ++w) {
+            for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+                array.push_back(static_cast<uint16_t>(w * 64 + std::countr_zero(word)));
+            }
+        }
+        words.clear();
+        words.shrink_to_fit();
+    }
+}
+
+RoaringBitmap RoaringBitmap::range(uint32_t end) {
+    RoaringBitmap result;
+    for (uint64_t start = 0; start < end; start += 65536) {
+        Container container;
+        container.key = static_cast<uint16_t>(start >> 16);
+        uint32_t count = static_cast<uint32_t>(std::min<uint64_t>(65536, end - start));
+        container.cardinality = count;
+        if (count > ARRAY_LIMIT) {
+            container.words.assign(CONTAINER_WORDS, 0);
+            for (uint32_t w = 0; w < count / 64; ++w) {
+                container.words[w] = ~uint64_t(0);
+            }
+            if (count % 64) {
+                container.words[count / 64] = (uint64_t(1) << (count % 64)) - 1;
+            }
+        }
+        else {
+            container.array.resize(count);
+            for (uint32_t i = 0; i < count; ++i) {
+                container.array[i] = static_cast<uint16_t>(i);
+            }
+        }
+        result.containers.push_back(std::move(container));
+    }
+    return result;
+}
+
+RoaringBitmap::Container* RoaringBitmap::find_container(uint16_t key) {
+    auto it = std::lower_bound(containers.begin(), containers.end(), key,
+        [](const Container& container, uint16_t value) { return container.key < value; });
+    return (it != containers.end() && it->key == key) ? &*it : nullptr;
+}
+
+const RoaringBitmap::Container* RoaringBitmap::find_container(uint16_t key) const {
+    return const_cast<RoaringBitmap*>(this)->find_container(key);
+}
+
+void RoaringBitmap::add(uint32_t value) {
+    uint16_t key = static_cast<uint16_t>(value >> 16);
+    Container* container = (!containers.empty() && containers.back().key == key) ? &containers.back() : find_container(key);
+    if (!container) {
+        auto it = std::lower_bound(containers.begin(), containers.end(), key,
+            [](const Container& c, uint16_t k) { return c.key < k; });
+        it = containers.insert(it, Container());
+        it->key = key;
+        container = &*it;
+    }
+    container->add(static_cast<uint16_t>(value & 0xFFFF));
+}
+
+void RoaringBitmap::remove(uint32_t value) {
+    Container* container = find_container(static_cast<uint16_t>(value >> 16));
+    if (!container) {
+        return;
+    }
+    container->remove(static_cast<uint16_t>(value & 0xFFFF));
+    if (container->cardinality == 0) {
+        containers.erase(containers.begin() + (container - containers.data()));
+    }
+}
+
+bool RoaringBitmap::contains(uint32_t value) const {
+    const Container* container = find_container(static_cast<uint16_t>(value >> 16));
+    return container && container->contains(static_cast<uint16_t>(value & 0xFFFF));
+}
+
+uint64_t RoaringBitmap::cardinality() const {
+    uint64_t total = 0;
+    for (const auto& container : containers) {
+        total += container.cardinality;
+    }
+    return total;
+}
+
+RoaringBitmap::Container RoaringBitmap::combine(const Container& left, const Container& right, Op op) {
+    Container result;
+    result.key = left.key;
+    if (!left.dense() && !right.dense()) {
+        //    -   
+        auto out = std::back_inserter(result.array);
+        if (op == Op::And) {
+            std::set_intersection(left.array.begin(), left.array.end(), right.array.begin(), right.array.end(), out);
+        }
+        else if (op == Op::Or) {
+            std::set_union(left.array.begin(), left.array.end(), right.array.begin(), right.array.end(), out);
+        }
+        else {
+            std::set_difference(left.array.begin(), left.array.end(), right.array.begin(), right.array.end(), out);
+        }
+        result.cardinality = static_cast<uint32_t>(result.array.size());
+        result.normalize();
+        return result;
+    }
+    if (!left.dense() && op != Op::Or) {
+        //   :      
+        for (uint16_t low : left.array) {
+            if (right.contains(low) == (op == Op::And)) {
+                result.array.push_back(low);
+            }
+        }
+        result.cardinality = static_cast<uint32_t>(result.array.size());
+        return result;
+    }
+
+    std::vector<uint64_t> words = left.as_words();
+    std::vector<uint64_t> other = right.as_words();
+    uint32_t count = 0;
+    for (size_t w = 0; w < CONTAINER_WORDS; ++w) {
+        if (op == Op::And) {
+            words[w] &= other[w];
+        }
+        else if (op == Op::Or) {
+            words[w] |= other[w];
+        }
+        else {
+            words[w] &= ~other[w];
+        }
+        count += static_cast<uint32_t>(std::popcount(words[w]));
+    }
+    result.words = std::move(words);
+    result.cardinality = count;
+    result.normalize();
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::combine(const RoaringBitmap& left, const RoaringBitmap& right, Op op) {
+    RoaringBitmap result;
+    size_t i = 0, j = 0;
+    while (i < left.containers.size() || j < right.containers.size()) {
+        bool has_left = i < left.containers.size();
+        bool has_right = j < right.containers.size();
+        if (has_left && (!has_right || left.containers[i].key < right.containers[j].key)) {
+            //    
+            if (op != Op::And) {
+                result.containers.push_back(left.containers[i]);
+            }
+            ++i;
+        }
+        else if (has_right && (!has_left || right.containers[j].key < left.containers[i].key)) {
+            if (op == Op::Or) {
+                result.containers.push_back(right.containers[j]);
+            }
+            ++j;
+        }
+        else {
+            Container container = combine(left.containers[i], right.containers[j], op);
+            if (container.cardinality > 0) {
+                result.containers.push_back(std::move(container));
+            }
+            ++i;
+            ++j;
+        }
+    }
+    return result;
+}
+
+RoaringBitmap RoaringBitmap::operator&(const RoaringBitmap& other) const {
+    return combine(*this, other, Op::And);
+}
+
+RoaringBitmap RoaringBitmap::operator|(const RoaringBitmap& other) const {
+    return combine(*this, other, Op::Or);
+}
+
+RoaringBitmap RoaringBitmap::operator-(const RoaringBitmap& other) const {
+    return combine(*this, other, Op::AndNot);
+}
+
+std::vector<size_t> RoaringBitmap::to_positions() const {
+    std::vector<size_t> result;
+    result.reserve(cardinality());
+    for (const auto& container : containers) {
+        size_t base = static_cast<size_t>(container.key) << 16;
+        if (container.dense()) {
+            for (size_t w = 0; w < CONTAINER_WORDS; ++w) {
+                for (uint64_t word = container.words[w]; word != 0; word &= word - 1) {
+                    result.push_back(base + w * 64 + std::countr_zero(word));
+                }
+            }
+        }
+        else {
+            for (uint16_t low : container.array) {
+                result.push_back(base + low);
+            }
+        }
+    }
+    return result;
+}
+
+size_t RoaringBitmap::memory_bytes() const {
+    size_t bytes = vector_bytes(containers);
+    for (const auto& container : containers) {
+        bytes += vector_bytes(container.array) + vector_bytes(container.words);
+    }
+    return bytes;
+}
@@ -0,0 +1,61 @@
+#ifndef BITMAP_H
+#define BITMAP_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//      (  Roaring).    
+//   16 ;       
+// ,   ( ARRAY_LIMIT ) -   1024   64 .
+class RoaringBitmap {
+public:
+    static const uint32_t ARRAY_LIMIT = 4096;
+
+    RoaringBitmap() = default;
+    //  [0, end).
+    static RoaringBitmap range(uint32_t end);
+
+    void add(uint32_t value);
+    void remove(uint32_t value);
+    bool contains(uint32_t value) const;
+    uint64_t cardinality() const;
+    bool empty() const { return containers.empty(); }
+
+    RoaringBitmap operator&(const RoaringBitmap& other) const;
+    RoaringBitmap operator|(const RoaringBitmap& other) const;
+    RoaringBitmap operator-(const RoaringBitmap& other) const;    //  (AND NOT)
+    RoaringBitmap& operator|=(const RoaringBitmap& other) { return *this = *this | other; }
+
+    //   .
+    std::vector<size_t> to_positions() const;
+    //     .
+    size_t memory_bytes() const;
+
+private:
+    struct Container {
+        uint16_t key = 0;                 //  16   
+        uint32_t cardinality = 0;
+        std::vector<uint16_t> array;      //  :  16   
+        std::vector<uint64_t> words;      //  : 1024  ( )
+
+        bool dense() const { return !words.empty(); }
+        bool contains(uint16_t low) const;
+        void add(uint16_t low);
+        void remove(uint16_t low);
+        std::vector<uint64_t> as_words() const;
+        //     .
+        void normalize();
+    };
+
+    std::vector<Container> containers;  //   key,   
+
+    Container* find_container(uint16_t key);
+    const Container* find_container(uint16_t key) const;
+
+    enum class Op { And, Or, AndNot };
+    static Container combine(const Container& left, const Container& right, Op op);
+    static RoaringBitmap combine(const RoaringBitmap& left, const RoaringBitmap& right, Op op);
+};
+
+#endif // BITMAP_H
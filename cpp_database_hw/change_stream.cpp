@@ -0,0 +1,164 @@
+#include "change_stream.h"
+#include <algorithm>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+#include "database.h"
+
+static const char RECORD_MAGIC[] = "CDC1";
+
+static int64_t now_ms() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+ChangeStreamWriter::ChangeStreamWriter(const std::string& path)
+    : path(path), out(path, std::ios::binary | std::ios::trunc) {
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to open change stream: " + path);
+    }
+}
+
+uint64_t ChangeStreamWriter::append(const std::string& script) {
+    //    ,       
+    std::ostringstream record;
+    record << RECORD_MAGIC << ' ' << (lsn + 1) << ' ' << now_ms() << ' ' << script.size() << '\n' << script << '\n';
+    out << record.str();
+    out.flush();
+    if (!out) {
+        throw std::runtime_error("Failed to write change stream: " + path);
+    }
+    return ++lsn;
+}
+
+ChangeStreamFollower::ChangeStreamFollower(Database& db, const std::string& path)
+    : db(db), path(path), caught_up_time(std::chrono::system_clock::now()) {
+}
+
+ChangeStreamFollower::~ChangeStreamFollower() {
+    stop();
+}
+
+size_t ChangeStreamFollower::poll() {
+    std::lock_guard<std::mutex> poll_lock(poll_mutex);
+    if (!in.is_open()) {
+        in.open(path, std::ios::binary);
+        if (!in.is_open()) {
+            throw std::runtime_error("Failed to open change stream: " + path);
+        }
+    }
+
+    //  ,     ;   -  
+    char block[64 * 1024];
+    while (in.read(block, sizeof(block)) || in.gcount() > 0) {
+        buffer.append(block, static_cast<size_t>(in.gcount()));
+    }
+    in.clear();
+
+    size_t applied = 0;
+    size_t offset = 0;
+    while (true) {
+        size_t header_end = buffer.find('\n', offset);
+        if (header_end == std::string::npos) {
+            break;
+        }
+        std::istringstream header(buffer.substr(offset, header_end - offset));
+        std::string magic;
+        uint64_t lsn = 0, size = 0;
+        int64_t commit_ms = 0;
+        if (!(header >> magic >> lsn >> commit_ms >> size) || magic != RECORD_MAGIC) {
+            throw std::runtime_error("Corrupted change stream record after LSN " + std::to_string(state.applied_lsn) + ".");
+        }
+        size_t record_end = header_end + 1 + size + 1;
+        if (buffer.size() < record_end) {
+            break; //   
+        }
+        // applied_lsn   ,  poll_mutex
+        uint64_t expected = state.applied_lsn + 1;
+        if (lsn != expected) {
+            throw std::runtime_error("Change stream gap: expected LSN " + std::to_string(expected) +
+                ", got " + std::to_string(lsn) + ".");
+        }
+
+        db.execute_batch(buffer.substr(header_end + 1, size));
+
+        auto commit_time = std::chrono::system_clock::time_point(std::chrono::milliseconds(commit_ms));
+        {
+            std::lock_guard<std::mutex> status_lock(status_mutex);
+            state.applied_lsn = lsn;
+            state.last_commit_time = commit_time;
+            state.apply_delay = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now() - commit_time);
+            consumed += record_end - offset;
+        }
+        offset = record_end;
+        ++applied;
+    }
+    buffer.erase(0, offset);
+    if (buffer.empty()) {
+        //        
+        std::lock_guard<std::mutex> status_lock(status_mutex);
+        caught_up_time = std::chrono::system_clock::now();
+    }
+    return applied;
+}
+
+void ChangeStreamFollower::start(std::chrono::milliseconds interval) {
+    {
+        std::lock_guard<std::mutex> status_lock(status_mutex);
+        if (state.running) {
+            return;
+        }
+        state.running = true;
+        state.error.clear();
+    }
+    // ,  ,  
+    if (worker.joinable()) {
+        worker.join();
+    }
+    stopping = false;
+    worker = std::thread([this, interval]() {
+        while (!stopping) {
+            try {
+                poll();
+            }
+            catch (const std::exception& e) {
+                std::lock_guard<std::mutex> status_lock(status_mutex);
+                state.error = e.what();
+                break;
+            }
+            std::this_thread::sleep_for(interval);
+        }
+        std::lock_guard<std::mutex> status_lock(status_mutex);
+        state.running = false;
+        });
+}
+
+void ChangeStreamFollower::stop() {
+    stopping = true;
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+ReplicationStatus ChangeStreamFollower::status() const {
+    std::lock_guard<std::mutex> status_lock(status_mutex);
+    ReplicationStatus result = state;
+
+    //      ;    -   
+    std::error_code error;
+    if (std::filesystem::is_regular_file(path, error)) {
+        uint64_t size = std::filesystem::file_size(path, error);
+        result.pending_bytes = (!error && size > consumed) ? size - consumed : 0;
+        if (result.pending_bytes > 0) {
+            //       
+            //   ,     
+            result.lag = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now() - std::max(result.last_commit_time, caught_up_time));
+        }
+    }
+    else {
+        result.lag = result.apply_delay;
+    }
+    return result;
+}
@@ -0,0 +1,82 @@
+#ifndef CHANGE_STREAM_H
+#define CHANGE_STREAM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class Database; //  
+
+//    (CDC).   -   ,
+//  ';',       :
+//   CDC1 <> < ,   > <>\n<>\n
+//      1.          (FIFO).
+class ChangeStreamWriter {
+public:
+    //    (  ).
+    explicit ChangeStreamWriter(const std::string& path);
+
+    //       ;   .
+    uint64_t append(const std::string& script);
+    uint64_t last_lsn() const { return lsn; }
+    const std::string& get_path() const { return path; }
+
+private:
+    std::string path;
+    std::ofstream out;
+    uint64_t lsn = 0;
+};
+
+//   .
+struct ReplicationStatus {
+    uint64_t applied_lsn = 0;                           //    
+    std::chrono::system_clock::time_point last_commit_time; //      
+    std::chrono::milliseconds apply_delay{ 0 };         //      
+    uint64_t pending_bytes = 0;                         //      ( )
+    std::chrono::milliseconds lag{ 0 };                 //   ; 0 -   
+    bool running = false;
+    std::string error;                                  // ,  
+};
+
+//  :            
+//  Database::execute_batch.      
+//      (     start_change_stream).
+class ChangeStreamFollower {
+public:
+    ChangeStreamFollower(Database& db, const std::string& path);
+    ChangeStreamFollower(const ChangeStreamFollower&) = delete;
+    ChangeStreamFollower& operator=(const ChangeStreamFollower&) = delete;
+    ~ChangeStreamFollower();
+
+    //     ;   .
+    //      ,   .
+    size_t poll();
+
+    //  ,     interval.  
+    //      status().error.
+    void start(std::chrono::milliseconds interval = std::chrono::milliseconds(20));
+    void stop();
+
+    ReplicationStatus status() const;
+
+private:
+    Database& db;
+    std::string path;
+    std::ifstream in;
+    std::string buffer;         // ,     
+    uint64_t consumed = 0;      //     
+    std::chrono::system_clock::time_point caught_up_time; //       
+
+    mutable std::mutex status_mutex;
+    ReplicationStatus state;
+
+    std::mutex poll_mutex;      //        
+    std::thread worker;
+    std::atomic<bool> stopping{ false };
+};
+
+#endif // CHANGE_STREAM_H
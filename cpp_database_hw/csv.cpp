@@ -0,0 +1,363 @@
+#include "csv.h"
+#include <algorithm>
+#include <charconv>
+#include <deque>
+#include <fstream>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <unordered_set>
+
+namespace {
+
+using RowBatch = std::vector<std::vector<Value>>;
+
+//  ,     CSV.
+struct CsvTarget {
+    size_t ordinal;
+    std::string name;
+    std::string type;
+};
+
+struct CsvField {
+    std::string text;
+    bool quoted = false;
+};
+
+//      pos; pos    .
+//     -  .
+void read_record(const std::string& data, size_t& pos, std::vector<CsvField>& fields, size_t& line) {
+    fields.clear();
+    while (true) {
+        CsvField field;
+        if (pos < data.size() && data[pos] == '"') {
+            field.quoted = true;
+            ++pos;
+            while (true) {
+                if (pos >= data.size()) {
+                    throw std::runtime_error("CSV line " + std::to_string(line) + ": unterminated quoted field.");
+                }
+                char c = data[pos++];
+                if (c == '"') {
+                    if (pos < data.size() && data[pos] == '"') {
+                        field.text += '"';
+                        ++pos;
+                        continue;
+                    }
+                    break;
+                }
+                if (c == '\n') {
+                    ++line;
+                }
+                field.text += c;
+            }
+        }
+        else {
+            size_t end = data.find_first_of(",\n", pos);
+            if (end == std::string::npos) {
+                end = data.size();
+            }
+            field.text.assign(data, pos, end - pos);
+            //      :      
+            if (field.text.find('"') != std::string::npos) {
+                throw std::runtime_error("CSV line " + std::to_string(line) + ": quote inside unquoted field.");
+            }
+            pos = end;
+        }
+        if (pos < data.size() && data[pos] == '\r') {
+            ++pos;
+        }
+        //   \r  \n    
+        if (!field.quoted && !field.text.empty() && field.text.back() == '\r') {
+            field.text.pop_back();
+        }
+        fields.push_back(std::move(field));
+
+        if (pos >= data.size()) {
+            return;
+        }
+        char separator = data[pos++];
+        if (separator == '\n') {
+            ++line;
+            return;
+        }
+        if (separator != ',') {
+            throw std::runtime_error("CSV line " + std::to_string(line) + ": unexpected character after quoted field.");
+        }
+    }
+}
+
+Value convert_field(const CsvField& field, const CsvTarget& target, size_t line) {
+    if (field.text.empty() && !field.quoted) {
+        return Value();
+    }
+    if (target.type == "string") {
+        return field.text;
+    }
+    if (target.type == "int32") {
+        int value = 0;
+        const char* begin = field.text.data();
+        const char* end = begin + field.text.size();
+        auto [ptr, error] = std::from_chars(begin, end, value);
+        if (error != std::errc() || ptr != end) {
+            throw std::runtime_error("CSV line " + std::to_string(line) + ": invalid int32 value '" + field.text +
+                "' for column " + target.name + ".");
+        }
+        return value;
+    }
+    if (target.type == "bool") {
+        if (field.text == "true" || field.text == "false") {
+            return field.text == "true";
+        }
+        throw std::runtime_error("CSV line " + std::to_string(line) + ": invalid bool value '" + field.text +
+            "' for column " + target.name + ".");
+    }
+    throw std::runtime_error("Unsupported column type: " + target.type);
+}
+
+//   ,    .    .
+RowBatch parse_chunk(const std::string& data, size_t first_line, const std::vector<CsvTarget>& targets, size_t column_count) {
+    RowBatch batch;
+    std::vector<CsvField> fields;
+    size_t pos = 0;
+    size_t line = first_line;
+    while (pos < data.size()) {
+        size_t record_line = line;
+        //   
+        if (data[pos] == '\n' || (data[pos] == '\r' && pos + 1 < data.size() && data[pos + 1] == '\n')) {
+            pos += (data[pos] == '\r') ? 2 : 1;
+            ++line;
+            continue;
+        }
+        read_record(data, pos, fields, line);
+        if (fields.size() != targets.size()) {
+            throw std::runtime_error("CSV line " + std::to_string(record_line) + ": expected " +
+                std::to_string(targets.size()) + " fields, got " + std::to_string(fields.size()) + ".");
+        }
+        std::vector<Value> row(column_count);
+        for (size_t i = 0; i < fields.size(); ++i) {
+            row[targets[i].ordinal] = convert_field(fields[i], targets[i], record_line);
+        }
+        batch.push_back(std::move(row));
+    }
+    return batch;
+}
+
+void append_csv_field(std::string& out, const std::string& value) {
+    bool needs_quotes = value.empty() || value.find_first_of(",\"\r\n") != std::string::npos;
+    if (!needs_quotes) {
+        out += value;
+        return;
+    }
+    out += '"';
+    for (char c : value) {
+        if (c == '"') {
+            out += '"';
+        }
+        out += c;
+    }
+    out += '"';
+}
+
+std::string format_chunk(const ResultBatch& batch) {
+    std::string out;
+    char number[16];
+    for (size_t row = 0; row < batch.row_count; ++row) {
+        for (size_t c = 0; c < batch.columns.size(); ++c) {
+            const ColumnBatch& column = batch.columns[c];
+            if (c > 0) {
+                out += ',';
+            }
+            if (!column.is_valid(row)) {
+                continue;
+            }
+            if (column.type == "int32") {
+                auto result = std::to_chars(number, number + sizeof(number), column.int_at(row));
+                out.append(number, result.ptr);
+            }
+            else if (column.type == "bool") {
+                out += column.bool_at(row) ? "true" : "false";
+            }
+            else {
+                append_csv_field(out, column.string_at(row));
+            }
+        }
+        out += '\n';
+    }
+    return out;
+}
+
+size_t worker_count(const CsvOptions& options) {
+    return options.threads ? options.threads : std::max(1u, std::thread::hardware_concurrency());
+}
+
+}
+
+size_t import_csv(Table& table, const std::string& filename, const CsvOptions& options) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open file: " + filename);
+    }
+
+    // :   ,       
+    std::string header;
+    if (!std::getline(in, header)) {
+        throw std::runtime_error("CSV file is empty: " + filename);
+    }
+    if (header.compare(0, 3, "\xEF\xBB\xBF") == 0) {
+        header.erase(0, 3);
+    }
+    std::vector<CsvField> fields;
+    size_t pos = 0, line = 1;
+    read_record(header, pos, fields, line);
+    std::vector<CsvTarget> targets;
+    std::set<std::string> seen;
+    for (const auto& field : fields) {
+        if (!seen.insert(field.text).second) {
+            throw std::runtime_error("Duplicate column in CSV header: " + field.text);
+        }
+        const auto& table_columns = table.get_columns();
+        auto it = std::find(table_columns.begin(), table_columns.end(), field.text);
+        if (it == table_columns.end()) {
+            throw std::runtime_error("Column " + field.text + " not found.");
+        }
+        targets.push_back({ static_cast<size_t>(it - table_columns.begin()), field.text, table.get_column_type(field.text) });
+    }
+    size_t column_count = table.get_columns().size();
+
+    //  ID,    INSERT,     
+    int id_ordinal = -1;
+    std::unordered_set<int> ids;
+    for (const auto& target : targets) {
+        if (target.name == "id" && target.type == "int32") {
+            id_ordinal = static_cast<int>(target.ordinal);
+            ResultBatch existing = table.scan_batch(0, table.row_count(), { "id" });
+            for (size_t i = 0; i < existing.row_count; ++i) {
+                if (existing.columns[0].is_valid(i)) {
+                    ids.insert(existing.columns[0].int_at(i));
+                }
+            }
+        }
+    }
+
+    size_t threads = worker_count(options);
+    size_t loaded = 0;
+    std::deque<std::future<RowBatch>> in_flight;
+
+    //         
+    auto apply_oldest = [&]() {
+        RowBatch batch = in_flight.front().get();
+        in_flight.pop_front();
+        if (id_ordinal >= 0) {
+            for (const auto& row : batch) {
+                const auto& cell = row[id_ordinal];
+                if (cell.has_value() && !ids.insert(cell.as_int()).second) {
+                    throw std::runtime_error("Duplicate ID detected: " + std::to_string(cell.as_int()));
+                }
+            }
+        }
+        loaded += batch.size();
+        table.insert_batch(std::move(batch));
+        };
+
+    try {
+        std::string buffer;
+        std::vector<char> block(options.chunk_bytes);
+        line = 2;
+        bool eof = false;
+        while (!eof) {
+            in.read(block.data(), block.size());
+            buffer.append(block.data(), static_cast<size_t>(in.gcount()));
+            eof = !in;
+
+            //   -      (  
+            //  ,   )
+            size_t boundary = std::string::npos;
+            size_t newlines = 0, newlines_at_boundary = 0;
+            bool quoted = false;
+            for (size_t i = 0; i < buffer.size(); ++i) {
+                char c = buffer[i];
+                if (c == '"') {
+                    quoted = !quoted;
+                }
+                else if (c == '\n') {
+                    ++newlines;
+                    if (!quoted) {
+                        boundary = i;
+                        newlines_at_boundary = newlines;
+                    }
+                }
+            }
+            if (eof) {
+                boundary = buffer.size() - 1;
+                newlines_at_boundary = newlines;
+            }
+            if (buffer.empty() || boundary == std::string::npos) {
+                continue;
+            }
+
+            std::string chunk = buffer.substr(0, boundary + 1);
+            buffer.erase(0, boundary + 1);
+            while (in_flight.size() >= threads) {
+                apply_oldest();
+            }
+            in_flight.push_back(std::async(std::launch::async, [chunk = std::move(chunk), line, &targets, column_count]() {
+                return parse_chunk(chunk, line, targets, column_count);
+                }));
+            line += newlines_at_boundary;
+        }
+        while (!in_flight.empty()) {
+            apply_oldest();
+        }
+    }
+    catch (const std::exception& e) {
+        //      
+        throw std::runtime_error(std::string(e.what()) + " (" + std::to_string(loaded) + " rows loaded before the error)");
+    }
+    return loaded;
+}
+
+size_t export_csv(const Table& table, const std::string& filename, const CsvOptions& options) {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot open file for writing: " + filename);
+    }
+
+    std::string header;
+    for (const auto& column : table.get_columns()) {
+        if (!header.empty()) {
+            header += ',';
+        }
+        append_csv_field(header, column);
+    }
+    out << header << '\n';
+
+    //       
+    size_t threads = worker_count(options);
+    size_t batch_rows = std::max<size_t>(1, options.export_batch_rows);
+    std::deque<std::future<std::string>> in_flight;
+    auto write_oldest = [&]() {
+        std::string text = in_flight.front().get();
+        in_flight.pop_front();
+        out.write(text.data(), text.size());
+        };
+
+    size_t total = table.row_count();
+    for (size_t first = 0; first < total; first += batch_rows) {
+        while (in_flight.size() >= threads) {
+            write_oldest();
+        }
+        ResultBatch batch = table.scan_batch(first, batch_rows);
+        in_flight.push_back(std::async(std::launch::async, [batch = std::move(batch)]() {
+            return format_chunk(batch);
+            }));
+    }
+    while (!in_flight.empty()) {
+        write_oldest();
+    }
+
+    if (!out) {
+        throw std::runtime_error("Failed to write file: " + filename);
+    }
+    return total;
+}
@@ -0,0 +1,22 @@
+#ifndef CSV_H
+#define CSV_H
+
+#include <string>
+#include "table.h"
+
+//  COPY.    chunk_bytes * threads * 2.
+struct CsvOptions {
+    size_t chunk_bytes = 4 << 20;   //   ,   
+    size_t threads = 0;             // 0 -   
+    size_t export_batch_rows = 16384;
+};
+
+// COPY t FROM:    -    ,   
+//  - NULL.         
+//   .    .
+size_t import_csv(Table& table, const std::string& filename, const CsvOptions& options = {});
+
+// COPY t TO:    ,    .
+size_t export_csv(const Table& table, const std::string& filename, const CsvOptions& options = {});
+
+#endif // CSV_H
@@ -1,53 +1,728 @@
 #include "database.h"
 #include "query_processor.h"
 #include <fstream>
+#include <filesystem>
 #include <stdexcept>
 #include <sstream>
 #include <iostream>
+#include <limits>
+#include <set>
+#include <algorithm>
+#include "encoding.h"
+#include "utils.h"
+#include "view.h"
 
-void Database::create_table(const std::string& name, const std::map<std::string, std::string>& schema) {
-    if (tables.find(name) != tables.end()) {
+Database::~Database() {
+    //     :    
+    pool.reset();
+    wait_for_snapshots();
+}
+
+//     :     .
+static const char FILE_MAGIC[] = "CPPDB2";
+static const char DIRECTORY_MAGIC[] = "DIR2";
+static const size_t FOOTER_SIZE = 8 + sizeof(DIRECTORY_MAGIC) - 1;
+
+void Database::create_table(const std::string& name, const std::map<std::string, std::string>& schema,
+    const PartitionScheme& partitioning) {
+    if (tables.find(name) != tables.end() || pending_tables.find(name) != pending_tables.end()) {
         throw std::runtime_error("Table already exists: " + name);
     }
-    tables[name] = std::make_shared<Table>(schema);
+    tables[name] = std::make_shared<Table>(schema, partitioning);
+}
+
+void Database::create_materialized_view(const std::string& name, const std::string& query) {
+    if (find_table(name)) {
+        throw std::runtime_error("Table already exists: " + name);
+    }
+    ViewDefinition definition = parse_view_query(query);
+    Table* base = get_table_for_write(definition.base_table);
+    if (!base) {
+        throw std::runtime_error("Table not found: " + definition.base_table);
+    }
+    if (base->is_view()) {
+        throw std::runtime_error("Materialized view over view " + definition.base_table + " is not supported.");
+    }
+
+    auto view = std::make_shared<Table>(view_schema(definition, *base));
+    view->set_view_query(query);
+    // ,    ,    
+    refresh_views();
+    RowChanges initial;
+    initial.inserted = base->all_rows();
+    apply_view_changes(*view, definition, *base, initial);
+    base->add_dependent_view(name);
+    tables[name] = view;
+}
+
+void Database::refresh_views() {
+    std::vector<std::string> changed;
+    for (const auto& [name, table] : tables) {
+        if (table->has_changes()) {
+            changed.push_back(name);
+        }
+    }
+    for (const auto& name : changed) {
+        Table* base = get_table_for_write(name);
+        RowChanges changes = base->take_changes();
+        for (const auto& view_name : base->get_dependent_views()) {
+            Table* view = get_table_for_write(view_name);
+            if (view) {
+                apply_view_changes(*view, parse_view_query(view->get_view_query()), *base, changes);
+            }
+        }
+    }
+}
+
+std::shared_ptr<Table>* Database::find_table(const std::string& name) {
+    //  SELECT      
+    std::lock_guard<std::mutex> catalog_lock(catalog_mutex);
+    auto it = tables.find(name);
+    if (it != tables.end()) {
+        return &it->second;
+    }
+
+    auto pending = pending_tables.find(name);
+    if (pending == pending_tables.end()) {
+        return nullptr;
+    }
+    std::shared_ptr<Table> table;
+    try {
+        table = pending->second.get();
+    }
+    catch (const std::exception& e) {
+        throw std::runtime_error("Failed to load table " + name + ": " + e.what());
+    }
+    pending_tables.erase(pending);
+
+    //       ,    
+    //       
+    for (auto& saved : transaction_stack) {
+        saved.emplace(name, table);
+    }
+    return &(tables[name] = table);
+}
+
+std::map<std::string, std::shared_ptr<Table>> Database::all_tables() const {
+    std::lock_guard<std::mutex> catalog_lock(catalog_mutex);
+    auto result = tables;
+    for (const auto& [name, loader] : pending_tables) {
+        result[name] = loader.get();
+    }
+    return result;
 }
 
 Table* Database::get_table(const std::string& name) {
-    if (tables.find(name) == tables.end()) {
+    auto table = find_table(name);
+    return table ? table->get() : nullptr;
+}
+
+Table* Database::get_table_for_write(const std::string& name) {
+    auto table = find_table(name);
+    if (!table) {
         return nullptr;
     }
-    return tables[name].get();
+    //       :   
+    if (table->use_count() > 1) {
+        check_transaction_memory(name, **table);
+        *table = (*table)->clone();
+    }
+    (*table)->bump_version();
+    return table->get();
+}
+
+std::vector<std::string> Database::table_names() const {
+    std::lock_guard<std::mutex> catalog_lock(catalog_mutex);
+    std::vector<std::string> names;
+    for (const auto& [name, table] : tables) {
+        names.push_back(name);
+    }
+    for (const auto& [name, loader] : pending_tables) {
+        names.push_back(name);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+size_t Database::pending_table_count() const {
+    return pending_tables.size();
+}
+
+template <typename Run>
+auto Database::run_query(const std::string& query, Run run) {
+    QueryContext local_context;
+    const QueryContext* context = current_query_context;
+    if (!context) {
+        local_context.memory_limit = get_memory_limits().query_bytes;
+        context = &local_context;
+    }
+    ScopedQueryContext context_scope(context);
+    std::list<RunningQuery>::iterator running;
+    {
+        std::lock_guard<std::mutex> lock(running_mutex);
+        running = running_queries.insert(running_queries.end(), { query, context, std::chrono::steady_clock::now() });
+    }
+    auto finish = [&]() {
+        std::lock_guard<std::mutex> lock(running_mutex);
+        running_queries.erase(running);
+        };
+    try {
+        auto result = run();
+        finish();
+        return result;
+    }
+    catch (...) {
+        finish();
+        throw;
+    }
+}
+
+void Database::read_table(const std::string& name, const std::function<void(const Table&)>& read) {
+    run_query("read_table " + name, [&]() {
+        std::shared_lock<std::shared_mutex> lock(database_mutex);
+        Table* table = get_table(name);
+        if (!table) throw std::runtime_error("Table not found: " + name);
+        read(*table);
+        return true;
+        });
+}
+
+void Database::write_table(const std::string& name, const std::function<void(Table&)>& write) {
+    run_query("write_table " + name, [&]() {
+        std::unique_lock<std::shared_mutex> lock(database_mutex);
+        Table* table = get_table(name);
+        if (!table) throw std::runtime_error("Table not found: " + name);
+        if (table->is_view()) throw std::runtime_error("Cannot modify materialized view " + name + ".");
+        try {
+            write(*get_table_for_write(name));
+        }
+        catch (...) {
+            refresh_views();
+            throw;
+        }
+        refresh_views();
+        return true;
+        });
+}
+
+// ,   : EXPLAIN ANALYZE  ,      .
+static std::string changing_statement(const std::string& statement) {
+    std::istringstream stream(statement);
+    std::string command, next;
+    stream >> command >> next;
+    if (command != "EXPLAIN" || next != "ANALYZE") {
+        return statement;
+    }
+    std::string inner;
+    std::getline(stream, inner);
+    return trim(inner);
+}
+
+// COPY t FROM  ,     ,     .
+static bool is_copy_from(const std::string& statement) {
+    std::istringstream stream(changing_statement(statement));
+    std::string command, table_name, direction;
+    stream >> command >> table_name >> direction;
+    return command == "COPY" && direction == "FROM";
+}
+
+// ,    : EXPLAIN  ANALYZE    ( SHOW),
+// EXPLAIN ANALYZE   .
+static std::string effective_command(const std::string& statement) {
+    std::istringstream stream(statement);
+    std::string command, next;
+    stream >> command;
+    if (command == "EXPLAIN") {
+        stream >> next;
+        if (next != "ANALYZE") {
+            return "SHOW";
+        }
+        stream >> command;
+    }
+    return command;
+}
+
+//    :          .
+static bool is_read_only(const std::string& statement) {
+    std::string command = effective_command(statement);
+    if (command == "COPY") {
+        // COPY t TO   
+        std::istringstream stream(changing_statement(statement));
+        std::string table_name, direction;
+        stream >> command >> table_name >> direction;
+        return direction == "TO";
+    }
+    return command == "SELECT" || command == "SHOW";
 }
 
 std::string Database::execute(const std::string& query) {
+    CaptureScope capture_scope(active_capture(), WorkloadEntry::Kind::Statement, query);
+    std::string result = run_query(query, [&]() { return execute_statement(query); });
+    capture_scope.finish();
+    return result;
+}
+
+std::string Database::execute_statement(const std::string& query) {
+    std::string command = effective_command(query);
     QueryProcessor processor;
-    return processor.parse_and_execute(*this, query);
+    if (is_read_only(query)) {
+        std::shared_lock<std::shared_mutex> lock(database_mutex);
+        if (command == "SELECT" && result_cache.enabled()) {
+            return execute_cached_select(query);
+        }
+        return processor.parse_and_execute(*this, query);
+    }
+    std::unique_lock<std::shared_mutex> lock(database_mutex);
+    if (change_stream && is_copy_from(query)) {
+        throw std::runtime_error("COPY FROM is not allowed while a change stream is active.");
+    }
+    std::string result;
+    try {
+        result = processor.parse_and_execute(*this, query);
+    }
+    catch (...) {
+        //       :    
+        refresh_views();
+        throw;
+    }
+    refresh_views();
+    log_change(changing_statement(query));
+    return result;
+}
+
+std::vector<std::string> Database::execute_batch(const std::string& script) {
+    CaptureScope capture_scope(active_capture(), WorkloadEntry::Kind::Batch, script);
+    std::vector<std::string> results = run_query(script, [&]() {
+        std::vector<std::string> statements = split_statements(script);
+        std::unique_lock<std::shared_mutex> lock(database_mutex);
+        if (change_stream && std::any_of(statements.begin(), statements.end(), is_copy_from)) {
+            throw std::runtime_error("COPY FROM is not allowed while a change stream is active.");
+        }
+        //        ,  ,
+        //      ,    
+        transaction_stack.push_back(tables);
+        std::vector<std::string> statement_results;
+        try {
+            statement_results = QueryProcessor::execute_script(*this, statements, [this]() { refresh_views(); });
+            refresh_views();
+            std::string committed;
+            for (const auto& statement : statements) {
+                if (!is_read_only(statement)) {
+                    committed += (committed.empty() ? "" : ";\n") + changing_statement(statement);
+                }
+            }
+            if (!committed.empty()) {
+                log_change(committed);
+            }
+        }
+        catch (...) {
+            //     (copy-on-write),  - 
+            tables = transaction_stack.back();
+            transaction_stack.pop_back();
+            throw;
+        }
+        transaction_stack.pop_back();
+        return statement_results;
+        });
+    capture_scope.finish();
+    return results;
+}
+
+std::string Database::execute_cached_select(const std::string& query) {
+    std::string key = normalize_statement(query);
+    std::istringstream stream(key);
+    std::string command, columns, from_kw, table_name;
+    stream >> command >> columns >> from_kw >> table_name;
+    Table* table = get_table(table_name);
+    if (from_kw != "FROM" || !table) {
+        //    
+        return QueryProcessor::parse_and_execute(*this, query);
+    }
+
+    //      ,      
+    uint64_t version = table->get_version();
+    std::string result;
+    size_t rows = 0;
+    if (result_cache.lookup(key, version, result, rows)) {
+        note_rows_affected(rows);
+        return result;
+    }
+    ResultBatch batch = QueryProcessor::select_batch(*this, query);
+    note_rows_affected(batch.row_count);
+    result = format_result_batch(batch);
+    result_cache.store(key, version, result, batch.row_count);
+    return result;
+}
+
+void Database::set_result_cache_capacity(size_t bytes) {
+    result_cache.set_capacity(bytes);
+}
+
+ResultBatch Database::execute_columnar(const std::string& query) {
+    return run_query(query, [&]() {
+        std::shared_lock<std::shared_mutex> lock(database_mutex);
+        return QueryProcessor::select_batch(*this, query);
+        });
+}
+
+void Database::set_memory_limits(const MemoryLimits& limits) {
+    std::lock_guard<std::mutex> lock(running_mutex);
+    memory_limits = limits;
+}
+
+MemoryLimits Database::get_memory_limits() const {
+    std::lock_guard<std::mutex> lock(running_mutex);
+    return memory_limits;
+}
+
+MemoryReport Database::memory_usage() const {
+    std::shared_lock<std::shared_mutex> lock(database_mutex);
+    return collect_memory_usage();
+}
+
+MemoryReport Database::collect_memory_usage() const {
+    MemoryReport report;
+    {
+        std::lock_guard<std::mutex> catalog_lock(catalog_mutex);
+        for (const auto& [name, table] : tables) {
+            report.tables[name] = table->memory_usage();
+        }
+    }
+    report.transactions = transaction_memory();
+    report.result_cache_bytes = result_cache.get_stats().bytes;
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard<std::mutex> lock(running_mutex);
+    for (const auto& running : running_queries) {
+        report.queries.push_back({ running.query, running.context->memory_in_use(), running.context->memory_limit,
+            std::chrono::duration_cast<std::chrono::milliseconds>(now - running.started) });
+    }
+    report.limits = memory_limits;
+    return report;
+}
+
+//     tables,    held;    held.
+static size_t unshared_table_bytes(const std::map<std::string, std::shared_ptr<Table>>& tables,
+    std::set<const Table*>& held) {
+    size_t bytes = 0;
+    for (const auto& [name, table] : tables) {
+        if (!held.insert(table.get()).second) {
+            continue;
+        }
+        if (!table->is_partitioned()) {
+            bytes += table->memory_usage().total();
+            continue;
+        }
+        //        
+        for (size_t i = 0; i < partition_count(table->get_partitioning()); ++i) {
+            const Table& partition = table->get_partition(i);
+            if (held.insert(&partition).second) {
+                bytes += partition.memory_usage().total();
+            }
+        }
+    }
+    return bytes;
+}
+
+std::vector<size_t> Database::transaction_memory() const {
+    //   ,       ,     
+    std::vector<size_t> result(transaction_stack.size(), 0);
+    std::set<const Table*> held;
+    unshared_table_bytes(tables, held);
+    for (size_t level = transaction_stack.size(); level-- > 0;) {
+        result[level] = unshared_table_bytes(transaction_stack[level], held);
+    }
+    return result;
+}
+
+void Database::check_transaction_memory(const std::string& name, const Table& table) const {
+    size_t limit = get_memory_limits().transaction_bytes;
+    if (!limit || transaction_stack.empty()) {
+        return;
+    }
+    auto saved = transaction_stack.back().find(name);
+    if (saved == transaction_stack.back().end() || saved->second.get() != &table) {
+        return; //    ,  
+    }
+    //       .   : 
+    //     ,    ,    
+    size_t retained = table.memory_usage().total();
+    for (size_t bytes : transaction_memory()) {
+        retained += bytes;
+    }
+    if (retained > limit) {
+        throw std::runtime_error("Transaction memory limit exceeded: modifying " + name + " would keep " +
+            std::to_string(retained) + " bytes for rollback, limit " + std::to_string(limit) + ".");
+    }
+}
+
+void Database::set_sort_options(const SortOptions& options) {
+    std::unique_lock<std::shared_mutex> lock(database_mutex);
+    sort_options = options;
+}
+
+void Database::configure_async(size_t thread_count, size_t queue_capacity) {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (pool) {
+        throw std::runtime_error("Async pool is already running.");
+    }
+    pool_threads = thread_count;
+    pool_queue_capacity = queue_capacity;
+}
+
+ThreadPool& Database::async_pool() {
+    std::lock_guard<std::mutex> lock(pool_mutex);
+    if (!pool) {
+        size_t threads = pool_threads ? pool_threads : std::max(1u, std::thread::hardware_concurrency());
+        pool = std::make_unique<ThreadPool>(threads, pool_queue_capacity);
+    }
+    return *pool;
+}
+
+std::shared_ptr<QueryContext> Database::execute_async(const std::string& query,
+    std::function<void(const std::string& result, std::exception_ptr error)> callback,
+    std::chrono::milliseconds timeout) {
+    auto context = std::make_shared<QueryContext>();
+    if (timeout.count() > 0) {
+        context->deadline = std::chrono::steady_clock::now() + timeout;
+    }
+    context->memory_limit = get_memory_limits().query_bytes;
+
+    async_pool().submit([this, query, context, callback]() {
+        std::string result;
+        std::exception_ptr error;
+        try {
+            //        
+            context->check();
+            ScopedQueryContext scope(context.get());
+            result = execute(query);
+        }
+        catch (...) {
+            error = std::current_exception();
+        }
+        try {
+            callback(result, error);
+        }
+        catch (const std::exception& e) {
+            std::cerr << "Async query callback failed: " << e.what() << "\n";
+        }
+        catch (...) {
+            //       :    
+            std::cerr << "Async query callback failed with an unknown exception.\n";
+        }
+        });
+    return context;
+}
+
+AsyncQuery Database::execute_async(const std::string& query, std::chrono::milliseconds timeout) {
+    auto promise = std::make_shared<std::promise<std::string>>();
+    AsyncQuery handle;
+    handle.result = promise->get_future();
+    handle.context = execute_async(query, [promise](const std::string& result, std::exception_ptr error) {
+        if (error) {
+            promise->set_exception(error);
+        }
+        else {
+            promise->set_value(result);
+        }
+        }, timeout);
+    return handle;
+}
+
+//        save_to_file:
+// ,   ,  (, , ) 
+//  8       .
+static void write_tables(std::ostream& file, const std::map<std::string, std::shared_ptr<Table>>& tables,
+    SnapshotProgress* progress) {
+    file << FILE_MAGIC << "\n";
+
+    ByteWriter directory;
+    directory.put_varint(tables.size());
+    for (const auto& [name, table] : tables) {
+        uint64_t offset = static_cast<uint64_t>(file.tellp());
+        table->save(file);
+        directory.put_string(name);
+        directory.put_varint(offset);
+        directory.put_varint(static_cast<uint64_t>(file.tellp()) - offset);
+        if (progress) {
+            ++progress->tables_written;
+        }
+    }
+
+    uint64_t directory_offset = static_cast<uint64_t>(file.tellp());
+    file.write(directory.data().data(), directory.data().size());
+    char footer[8];
+    for (int i = 0; i < 8; ++i) {
+        footer[i] = static_cast<char>((directory_offset >> (8 * i)) & 0xFF);
+    }
+    file.write(footer, sizeof(footer));
+    file.write(DIRECTORY_MAGIC, sizeof(DIRECTORY_MAGIC) - 1);
+}
+
+//         .
+static std::shared_ptr<Table> load_table_at(const std::string& filename, uint64_t offset, uint64_t size) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        throw std::runtime_error("Failed to open file for loading: " + filename);
+    }
+    file.seekg(static_cast<std::streamoff>(offset));
+    auto table = std::make_shared<Table>();
+    table->load(file);
+    if (static_cast<uint64_t>(file.tellg()) - offset != size) {
+        throw std::runtime_error("Table size does not match the directory.");
+    }
+    return table;
 }
 
 void Database::save_to_file(const std::string& filename) const {
+    std::shared_lock<std::shared_mutex> lock(database_mutex);
+    //     ,    
+    auto snapshot = all_tables();
+
     std::ofstream file(filename, std::ios::binary);
     if (!file.is_open()) {
         throw std::runtime_error("Failed to open file for saving: " + filename);
     }
 
-    file << tables.size() << "\n";
-    for (const auto& [name, table] : tables) {
-        file << name << "\n";
-        table->save(file);
+    write_tables(file, snapshot, nullptr);
+}
+
+std::shared_ptr<const SnapshotProgress> Database::snapshot_async(const std::string& filename) {
+    std::unique_lock<std::shared_mutex> lock(database_mutex);
+    std::lock_guard<std::mutex> snapshot_lock(snapshot_mutex);
+    //     
+    for (auto it = snapshot_threads.begin(); it != snapshot_threads.end();) {
+        if (it->second->finished) {
+            it->first.join();
+            it = snapshot_threads.erase(it);
+        }
+        else {
+            ++it;
+        }
+    }
+
+    //       :   
+    //   ,    get_table_for_write   .
+    auto view = std::make_shared<std::map<std::string, std::shared_ptr<Table>>>(all_tables());
+
+    auto progress = std::make_shared<SnapshotProgress>();
+    progress->tables_total = view->size();
+
+    std::thread worker([view, progress, filename]() mutable {
+        auto started = std::chrono::steady_clock::now();
+        std::string temp_name = filename + ".tmp";
+        try {
+            {
+                std::ofstream file(temp_name, std::ios::binary);
+                if (!file.is_open()) {
+                    throw std::runtime_error("Failed to open file for saving: " + temp_name);
+                }
+                write_tables(file, *view, progress.get());
+                file.flush();
+                if (!file) {
+                    throw std::runtime_error("Failed to write snapshot: " + temp_name);
+                }
+            }
+            //     ,     
+            view.reset();
+            std::filesystem::rename(temp_name, filename);
+        }
+        catch (const std::exception& e) {
+            view.reset();
+            std::error_code ignored;
+            std::filesystem::remove(temp_name, ignored);
+            progress->error = e.what();
+            progress->failed = true;
+        }
+        progress->duration = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - started);
+        progress->finished = true;
+
+        if (progress->failed) {
+            std::cerr << "Snapshot to " << filename << " failed: " << progress->error << "\n";
+        }
+        else {
+            std::cout << "Snapshot saved to " << filename << ": " << progress->tables_written
+                << " table(s) in " << progress->duration.count() << " ms.\n";
+        }
+        });
+    snapshot_threads.emplace_back(std::move(worker), progress);
+    return progress;
+}
+
+void Database::wait_for_snapshots() {
+    decltype(snapshot_threads) running;
+    {
+        std::lock_guard<std::mutex> snapshot_lock(snapshot_mutex);
+        running.swap(snapshot_threads);
+    }
+    for (auto& [thread, progress] : running) {
+        if (thread.joinable()) {
+            thread.join();
+        }
     }
 }
 
-void Database::load_from_file(const std::string& filename) {
+void Database::load_from_file(const std::string& filename, bool prefetch) {
+    std::unique_lock<std::shared_mutex> lock(database_mutex);
+    if (change_stream) {
+        throw std::runtime_error("Cannot load a database while a change stream is active.");
+    }
     std::ifstream file(filename, std::ios::binary);
     if (!file.is_open()) {
         throw std::runtime_error("Failed to open file for loading: " + filename);
     }
 
+    std::string header;
+    std::getline(file, header);
+    if (trim(header) == FILE_MAGIC) {
+        //      
+        file.seekg(0, std::ios::end);
+        uint64_t file_size = static_cast<uint64_t>(file.tellg());
+        if (file_size < FOOTER_SIZE) {
+            throw std::runtime_error("Data file is truncated: " + filename);
+        }
+        char footer[FOOTER_SIZE];
+        file.seekg(static_cast<std::streamoff>(file_size - FOOTER_SIZE));
+        file.read(footer, FOOTER_SIZE);
+        if (std::string(footer + 8, sizeof(DIRECTORY_MAGIC) - 1) != DIRECTORY_MAGIC) {
+            throw std::runtime_error("Table directory not found in " + filename);
+        }
+        uint64_t directory_offset = 0;
+        for (int i = 0; i < 8; ++i) {
+            directory_offset |= static_cast<uint64_t>(static_cast<unsigned char>(footer[i])) << (8 * i);
+        }
+        if (directory_offset > file_size - FOOTER_SIZE) {
+            throw std::runtime_error("Invalid table directory offset in " + filename);
+        }
+        std::string directory_data(file_size - FOOTER_SIZE - directory_offset, '\0');
+        file.seekg(static_cast<std::streamoff>(directory_offset));
+        file.read(directory_data.data(), directory_data.size());
+
+        tables.clear();
+        pending_tables.clear();
+        ByteReader directory(directory_data);
+        size_t table_count = directory.get_varint();
+        for (size_t i = 0; i < table_count; ++i) {
+            std::string name = directory.get_string();
+            uint64_t offset = directory.get_varint();
+            uint64_t size = directory.get_varint();
+            if (offset + size > directory_offset) {
+                throw std::runtime_error("Table " + name + " lies outside the data section.");
+            }
+            auto policy = prefetch ? std::launch::async : std::launch::deferred;
+            pending_tables[name] = std::async(policy, load_table_at, filename, offset, size).share();
+        }
+        return;
+    }
+
+    //      
+    file.seekg(0);
     size_t table_count;
     file >> table_count;
     file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 
     tables.clear();
+    pending_tables.clear();
     for (size_t i = 0; i < table_count; ++i) {
         std::string name;
         std::getline(file, name);
@@ -57,24 +732,104 @@ void Database::load_from_file(const std::string& filename) {
     }
 }
 
+void Database::start_change_stream(const std::string& path, const std::string& snapshot_path) {
+    std::unique_lock<std::shared_mutex> lock(database_mutex);
+    if (!transaction_stack.empty()) {
+        throw std::runtime_error("Cannot start a change stream inside a transaction.");
+    }
+    //        ,     
+    if (!snapshot_path.empty()) {
+        std::ofstream file(snapshot_path, std::ios::binary);
+        if (!file.is_open()) {
+            throw std::runtime_error("Failed to open file for saving: " + snapshot_path);
+        }
+        write_tables(file, all_tables(), nullptr);
+    }
+    change_stream = std::make_unique<ChangeStreamWriter>(path);
+    std::cout << "Change stream started: " << path << "\n";
+}
+
+void Database::stop_change_stream() {
+    std::unique_lock<std::shared_mutex> lock(database_mutex);
+    change_stream.reset();
+}
+
+uint64_t Database::change_stream_lsn() const {
+    std::shared_lock<std::shared_mutex> lock(database_mutex);
+    return change_stream ? change_stream->last_lsn() : 0;
+}
+
+void Database::log_change(const std::string& script) {
+    if (!change_stream) {
+        return;
+    }
+    if (!transaction_changes.empty()) {
+        transaction_changes.back().push_back(script);
+        return;
+    }
+    change_stream->append(script);
+}
+
 void Database::begin_transaction() {
+    CaptureScope capture_scope(active_capture(), WorkloadEntry::Kind::Transaction, "BEGIN");
+    std::unique_lock<std::shared_mutex> lock(database_mutex);
     transaction_stack.push_back(tables);
+    transaction_changes.emplace_back();
     std::cout << "Transaction started.\n";
+    capture_scope.finish();
 }
 
 void Database::rollback_transaction() {
+    CaptureScope capture_scope(active_capture(), WorkloadEntry::Kind::Transaction, "ROLLBACK");
+    std::unique_lock<std::shared_mutex> lock(database_mutex);
     if (transaction_stack.empty()) {
         throw std::runtime_error("No active transaction to rollback.");
     }
     tables = transaction_stack.back();
     transaction_stack.pop_back();
+    transaction_changes.pop_back();
     std::cout << "Transaction rolled back.\n";
+    capture_scope.finish();
 }
 
 void Database::commit_transaction() {
+    CaptureScope capture_scope(active_capture(), WorkloadEntry::Kind::Transaction, "COMMIT");
+    std::unique_lock<std::shared_mutex> lock(database_mutex);
     if (transaction_stack.empty()) {
         throw std::runtime_error("No active transaction to commit.");
     }
     transaction_stack.pop_back();
+    //     ,     
+    std::vector<std::string> committed = std::move(transaction_changes.back());
+    transaction_changes.pop_back();
+    std::string script;
+    for (const auto& statement : committed) {
+        script += (script.empty() ? "" : ";\n") + statement;
+    }
+    if (!script.empty()) {
+        log_change(script);
+    }
     std::cout << "Transaction committed.\n";
+    capture_scope.finish();
+}
+
+void Database::start_capture(const std::string& path) {
+    auto recorder = std::make_shared<WorkloadRecorder>(path);
+    std::lock_guard<std::mutex> lock(capture_mutex);
+    capture = std::move(recorder);
+}
+
+size_t Database::stop_capture() {
+    std::shared_ptr<WorkloadRecorder> recorder;
+    {
+        std::lock_guard<std::mutex> lock(capture_mutex);
+        recorder = std::move(capture);
+    }
+    //  ,   ,    
+    return recorder ? recorder->entry_count() : 0;
+}
+
+std::shared_ptr<WorkloadRecorder> Database::active_capture() const {
+    std::lock_guard<std::mutex> lock(capture_mutex);
+    return capture;
 }
@@ -5,24 +5,151 @@
 #include <map>
 #include <memory>
 #include <vector>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <list>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include "change_stream.h"
+#include "memory_usage.h"
 #include "table.h"
+#include "query_context.h"
+#include "result_cache.h"
+#include "thread_pool.h"
+#include "workload.h"
+
+//     .
+struct SnapshotProgress {
+    std::atomic<size_t> tables_total{ 0 };
+    std::atomic<size_t> tables_written{ 0 };
+    std::atomic<bool> finished{ false };
+    std::atomic<bool> failed{ false };
+    std::string error;                      //    finished
+    std::chrono::milliseconds duration{ 0 }; //    finished
+};
+
+// ,    execute_async.
+struct AsyncQuery {
+    std::future<std::string> result;
+    std::shared_ptr<QueryContext> context;
+
+    //  :     ,    .
+    void cancel() { context->cancelled = true; }
+};
 
 class Database {
 public:
-    //       .
-    void create_table(const std::string& name, const std::map<std::string, std::string>& schema);
+    Database() = default;
+    Database(const Database&) = delete;
+    Database& operator=(const Database&) = delete;
+    ~Database();
+
+    //       ,     .
+    void create_table(const std::string& name, const std::map<std::string, std::string>& schema,
+        const PartitionScheme& partitioning = {});
+
+    //      SELECT   .
+    //          
+    //        execute.
+    void create_materialized_view(const std::string& name, const std::string& query);
 
     //       .
     Table* get_table(const std::string& name);
 
+    //    .      
+    //   ,    (copy-on-write). 
+    //        ,    .
+    Table* get_table_for_write(const std::string& name);
+
+    //       SQL (TypedTable). read   
+    // ; write -  ,     (copy-on-write),
+    //     .   write_table,  
+    //  get_table_for_write,        .
+    void read_table(const std::string& name, const std::function<void(const Table&)>& read);
+    void write_table(const std::string& name, const std::function<void(Table&)>& write);
+
+    //    .
+    std::vector<std::string> table_names() const;
+
     //  SQL-      .
+    // SELECT, SHOW  COPY ... TO     ,   - .
     std::string execute(const std::string& query);
 
+    //    ,  ';',     .
+    //         :  
+    //         .
+    std::vector<std::string> execute_batch(const std::string& script);
+
+    //  SELECT       .
+    ResultBatch execute_columnar(const std::string& query);
+
+    //     .  timeout   .
+    AsyncQuery execute_async(const std::string& query, std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+    //        callback   
+    //    .
+    std::shared_ptr<QueryContext> execute_async(const std::string& query,
+        std::function<void(const std::string& result, std::exception_ptr error)> callback,
+        std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+
+    //        ORDER BY.
+    void set_sort_options(const SortOptions& options);
+    const SortOptions& get_sort_options() const { return sort_options; }
+
+    //   SELECT     ; 0 ( ) -  .
+    //      ,    .
+    void set_result_cache_capacity(size_t bytes);
+    ResultCacheStats get_result_cache_stats() const { return result_cache.get_stats(); }
+
+    //     ;   ,   .
+    void set_memory_limits(const MemoryLimits& limits);
+    MemoryLimits get_memory_limits() const;
+    //    ,  ,    ,
+    //    (   SHOW MEMORY).   .
+    MemoryReport memory_usage() const;
+    //       database_mutex (SHOW MEMORY  execute  ).
+    MemoryReport collect_memory_usage() const;
+
+    //       execute_async;     .
+    void configure_async(size_t thread_count, size_t queue_capacity);
+
     //      .
     void save_to_file(const std::string& filename) const;
 
-    //      .
-    void load_from_file(const std::string& filename);
+    //       .   
+    //      .
+    std::shared_ptr<const SnapshotProgress> snapshot_async(const std::string& filename);
+
+    //     .
+    void wait_for_snapshots();
+
+    //      .    ,
+    //      ;  prefetch  
+    //   .
+    void load_from_file(const std::string& filename, bool prefetch = false);
+
+    //  ,     .
+    size_t pending_table_count() const;
+
+    //   (CDC)    (ChangeStreamFollower):  
+    //   execute    execute_batch    path,
+    //   -      .  
+    // snapshot_path,       . ,
+    //    execute (create_table, get_table_for_write),    .
+    // EXPLAIN ANALYZE    ; COPY FROM    .
+    void start_change_stream(const std::string& path, const std::string& snapshot_path = "");
+    void stop_change_stream();
+    //    ; 0 -      .
+    uint64_t change_stream_lsn() const;
+
+    //     (replay_workload):   execute,
+    // execute_batch  ,        path
+    //   ,    . stop_capture   .
+    void start_capture(const std::string& path);
+    size_t stop_capture();
 
     //  .
     void begin_transaction();
@@ -35,7 +162,55 @@ public:
 
 private:
     std::map<std::string, std::shared_ptr<Table>> tables; //  
+    std::map<std::string, std::shared_future<std::shared_ptr<Table>>> pending_tables; // ,     
     std::vector<std::map<std::string, std::shared_ptr<Table>>> transaction_stack; //   
+    std::vector<std::pair<std::thread, std::shared_ptr<const SnapshotProgress>>> snapshot_threads; //   
+    std::unique_ptr<ChangeStreamWriter> change_stream;
+    std::vector<std::vector<std::string>> transaction_changes; //     
+    std::shared_ptr<WorkloadRecorder> capture;  //  ,   
+
+    struct RunningQuery {
+        std::string query;
+        const QueryContext* context;
+        std::chrono::steady_clock::time_point started;
+    };
+    std::list<RunningQuery> running_queries;
+    MemoryLimits memory_limits;
+
+    mutable std::shared_mutex database_mutex; //  - ,  - 
+    mutable std::mutex catalog_mutex;         //     
+    std::mutex snapshot_mutex;                //   
+    mutable std::mutex capture_mutex;         //  
+    mutable std::mutex running_mutex;         //     
+    std::mutex pool_mutex;
+    size_t pool_threads = 0;                  // 0 -   
+    size_t pool_queue_capacity = 1024;
+    std::unique_ptr<ThreadPool> pool;         //    execute_async
+    ResultCache result_cache;
+    SortOptions sort_options;                 //    
+
+    ThreadPool& async_pool();
+
+    std::string execute_statement(const std::string& query);
+    //  run    query (,   ), 
+    //         .
+    template <typename Run>
+    auto run_query(const std::string& query, Run run);
+    //    database_mutex.
+    std::vector<size_t> transaction_memory() const;
+    void check_transaction_memory(const std::string& name, const Table& table) const;
+    std::shared_ptr<WorkloadRecorder> active_capture() const;
+
+    //  ,      .
+    std::shared_ptr<Table>* find_table(const std::string& name);
+    // SELECT   ;    .
+    std::string execute_cached_select(const std::string& query);
+    //         .
+    void refresh_views();
+    //          .
+    void log_change(const std::string& script);
+    //  ,    .
+    std::map<std::string, std::shared_ptr<Table>> all_tables() const;
 };
 
 #endif // DATABASE_H
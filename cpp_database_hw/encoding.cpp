@@ -0,0 +1,414 @@
+#include "encoding.h"
+#include <algorithm>
+#include <limits>
+#include <map>
+#include <stdexcept>
+
+void ByteWriter::put_byte(uint8_t value) {
+    buffer.push_back(static_cast<char>(value));
+}
+
+void ByteWriter::put_varint(uint64_t value) {
+    while (value >= 0x80) {
+        put_byte(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    put_byte(static_cast<uint8_t>(value));
+}
+
+//     zigzag-,       .
+void ByteWriter::put_signed(int64_t value) {
+    put_varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+void ByteWriter::put_string(std::string_view value) {
+    put_varint(value.size());
+    buffer += value;
+}
+
+void ByteWriter::put_bytes(const std::string& bytes) {
+    buffer += bytes;
+}
+
+uint8_t ByteReader::get_byte() {
+    if (pos >= buffer.size()) {
+        throw std::runtime_error("Unexpected end of encoded data.");
+    }
+    return static_cast<uint8_t>(buffer[pos++]);
+}
+
+uint64_t ByteReader::get_varint() {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        uint8_t byte = get_byte();
+        result |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return result;
+        }
+    }
+    throw std::runtime_error("Malformed varint in encoded data.");
+}
+
+int64_t ByteReader::get_signed() {
+    uint64_t value = get_varint();
+    return static_cast<int64_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+std::string ByteReader::get_string() {
+    return get_bytes(get_varint());
+}
+
+std::string ByteReader::get_bytes(size_t count) {
+    if (count > buffer.size() - pos) {
+        throw std::runtime_error("Unexpected end of encoded data.");
+    }
+    std::string result = buffer.substr(pos, count);
+    pos += count;
+    return result;
+}
+
+//    width  ,    .
+static void pack_bits(ByteWriter& out, const std::vector<uint32_t>& values, unsigned width) {
+    uint64_t accumulator = 0;
+    unsigned filled = 0;
+    for (uint32_t value : values) {
+        accumulator |= static_cast<uint64_t>(value) << filled;
+        filled += width;
+        while (filled >= 8) {
+            out.put_byte(static_cast<uint8_t>(accumulator));
+            accumulator >>= 8;
+            filled -= 8;
+        }
+    }
+    if (filled > 0) {
+        out.put_byte(static_cast<uint8_t>(accumulator));
+    }
+}
+
+static std::vector<uint32_t> unpack_bits(ByteReader& in, size_t count, unsigned width) {
+    std::vector<uint32_t> values(count);
+    if (width == 0) {
+        return values;
+    }
+    uint64_t accumulator = 0;
+    unsigned filled = 0;
+    uint64_t mask = (width == 32) ? 0xFFFFFFFFull : ((1ull << width) - 1);
+    for (size_t i = 0; i < count; ++i) {
+        while (filled < width) {
+            accumulator |= static_cast<uint64_t>(in.get_byte()) << filled;
+            filled += 8;
+        }
+        values[i] = static_cast<uint32_t>(accumulator & mask);
+        accumulator >>= width;
+        filled -= width;
+    }
+    return values;
+}
+
+static unsigned bit_width(uint64_t max_value) {
+    unsigned width = 0;
+    while (max_value > 0) {
+        ++width;
+        max_value >>= 1;
+    }
+    return width;
+}
+
+static std::string encode_bools(const std::vector<bool>& values) {
+    ByteWriter bits;
+    bits.put_byte(static_cast<uint8_t>(ColumnEncoding::BoolBits));
+    std::vector<uint32_t> raw(values.begin(), values.end());
+    pack_bits(bits, raw, 1);
+
+    ByteWriter runs;
+    runs.put_byte(static_cast<uint8_t>(ColumnEncoding::BoolRle));
+    runs.put_byte(values.front() ? 1 : 0);
+    size_t run = 1;
+    for (size_t i = 1; i < values.size(); ++i) {
+        if (values[i] == values[i - 1]) {
+            ++run;
+        }
+        else {
+            runs.put_varint(run);
+            run = 1;
+        }
+    }
+    runs.put_varint(run);
+
+    return runs.data().size() < bits.data().size() ? runs.data() : bits.data();
+}
+
+static std::string encode_ints(const std::vector<int>& values) {
+    int64_t min_value = *std::min_element(values.begin(), values.end());
+    int64_t max_value = *std::max_element(values.begin(), values.end());
+
+    ByteWriter frame;
+    frame.put_byte(static_cast<uint8_t>(ColumnEncoding::IntFor));
+    unsigned width = bit_width(static_cast<uint64_t>(max_value - min_value));
+    frame.put_signed(min_value);
+    frame.put_byte(static_cast<uint8_t>(width));
+    std::vector<uint32_t> offsets;
+    offsets.reserve(values.size());
+    for (int value : values) {
+        offsets.push_back(static_cast<uint32_t>(value - min_value));
+    }
+    pack_bits(frame, offsets, width);
+
+    ByteWriter delta;
+    delta.put_byte(static_cast<uint8_t>(ColumnEncoding::IntDelta));
+    int64_t previous = 0;
+    for (int value : values) {
+        delta.put_signed(value - previous);
+        previous = value;
+    }
+
+    ByteWriter runs;
+    runs.put_byte(static_cast<uint8_t>(ColumnEncoding::IntRle));
+    for (size_t i = 0; i < values.size();) {
+        size_t j = i + 1;
+        while (j < values.size() && values[j] == values[i]) {
+            ++j;
+        }
+        runs.put_signed(values[i]);
+        runs.put_varint(j - i);
+        i = j;
+    }
+
+    const std::string* best = &frame.data();
+    if (delta.data().size() < best->size()) best = &delta.data();
+    if (runs.data().size() < best->size()) best = &runs.data();
+    return *best;
+}
+
+static std::string encode_strings(const std::vector<std::string_view>& values) {
+    ByteWriter plain;
+    plain.put_byte(static_cast<uint8_t>(ColumnEncoding::StringPlain));
+    for (std::string_view value : values) {
+        plain.put_string(value);
+    }
+
+    std::map<std::string_view, uint32_t> dictionary;
+    for (std::string_view value : values) {
+        dictionary.emplace(value, 0);
+    }
+    //     
+    if (dictionary.size() * 2 > values.size()) {
+        return plain.data();
+    }
+
+    ByteWriter dict;
+    dict.put_byte(static_cast<uint8_t>(ColumnEncoding::StringDict));
+    dict.put_varint(dictionary.size());
+    uint32_t code = 0;
+    for (auto& [value, value_code] : dictionary) {
+        value_code = code++;
+        dict.put_string(value);
+    }
+    unsigned width = bit_width(dictionary.size() - 1);
+    dict.put_byte(static_cast<uint8_t>(width));
+    std::vector<uint32_t> codes;
+    codes.reserve(values.size());
+    for (std::string_view value : values) {
+        codes.push_back(dictionary.at(value));
+    }
+    pack_bits(dict, codes, width);
+
+    return dict.data().size() < plain.data().size() ? dict.data() : plain.data();
+}
+
+static std::string encode_tagged(const std::vector<const Value*>& values) {
+    ByteWriter out;
+    out.put_byte(static_cast<uint8_t>(ColumnEncoding::Tagged));
+    for (const Value* value : values) {
+        if (value->is_int()) {
+            out.put_byte('i');
+            out.put_signed(value->as_int());
+        }
+        else if (value->is_bool()) {
+            out.put_byte('b');
+            out.put_byte(value->as_bool() ? 1 : 0);
+        }
+        else if (value->is_string()) {
+            out.put_byte('s');
+            out.put_string(value->as_string());
+        }
+        else {
+            throw std::runtime_error("Unsupported value type for saving.");
+        }
+    }
+    return out.data();
+}
+
+//  : [][ NULL][   ][  ].
+std::string encode_column_block(const std::vector<Value>& values) {
+    std::vector<const Value*> present;
+    std::vector<uint32_t> validity;
+    validity.reserve(values.size());
+    for (const auto& value : values) {
+        validity.push_back(value.has_value() ? 1 : 0);
+        if (value.has_value()) {
+            present.push_back(&value);
+        }
+    }
+
+    if (present.empty()) {
+        return std::string(1, static_cast<char>(ColumnEncoding::AllNull));
+    }
+
+    //       
+    Value::Type type = present.front()->type();
+    bool uniform = std::all_of(present.begin(), present.end(), [&](const Value* v) { return v->type() == type; });
+
+    std::string payload;
+    if (uniform && type == Value::Type::Bool) {
+        std::vector<bool> bools;
+        for (const Value* value : present) bools.push_back(value->as_bool());
+        payload = encode_bools(bools);
+    }
+    else if (uniform && type == Value::Type::Int) {
+        std::vector<int> ints;
+        for (const Value* value : present) ints.push_back(value->as_int());
+        payload = encode_ints(ints);
+    }
+    else if (uniform && type == Value::Type::String) {
+        std::vector<std::string_view> strings;
+        for (const Value* value : present) strings.push_back(value->as_string());
+        payload = encode_strings(strings);
+    }
+    else {
+        payload = encode_tagged(present);
+    }
+
+    ByteWriter block;
+    block.put_byte(static_cast<uint8_t>(payload[0]));
+    bool has_nulls = present.size() < values.size();
+    block.put_byte(has_nulls ? 1 : 0);
+    if (has_nulls) {
+        pack_bits(block, validity, 1);
+    }
+    block.put_bytes(payload.substr(1));
+    return block.data();
+}
+
+std::vector<Value> decode_column_block(const std::string& block, size_t count) {
+    ByteReader in(block);
+    auto encoding = static_cast<ColumnEncoding>(in.get_byte());
+    std::vector<Value> values(count);
+    if (encoding == ColumnEncoding::AllNull) {
+        return values;
+    }
+
+    std::vector<uint32_t> validity(count, 1);
+    if (in.get_byte() != 0) {
+        validity = unpack_bits(in, count, 1);
+    }
+    size_t present = std::count(validity.begin(), validity.end(), 1u);
+
+    std::vector<Value> decoded;
+    decoded.reserve(present);
+    switch (encoding) {
+    case ColumnEncoding::BoolBits:
+        for (uint32_t bit : unpack_bits(in, present, 1)) decoded.emplace_back(bit != 0);
+        break;
+    case ColumnEncoding::BoolRle: {
+        bool value = in.get_byte() != 0;
+        while (decoded.size() < present) {
+            size_t run = in.get_varint();
+            if (run == 0 || run > present - decoded.size()) {
+                throw std::runtime_error("Malformed run length in encoded block.");
+            }
+            decoded.insert(decoded.end(), run, Value(value));
+            value = !value;
+        }
+        break;
+    }
+    case ColumnEncoding::IntFor: {
+        int64_t min_value = in.get_signed();
+        unsigned width = in.get_byte();
+        if (width > 32) {
+            throw std::runtime_error("Malformed bit width in encoded block.");
+        }
+        for (uint32_t offset : unpack_bits(in, present, width)) {
+            decoded.emplace_back(static_cast<int>(min_value + offset));
+        }
+        break;
+    }
+    case ColumnEncoding::IntDelta: {
+        int64_t previous = 0;
+        for (size_t i = 0; i < present; ++i) {
+            previous += in.get_signed();
+            decoded.emplace_back(static_cast<int>(previous));
+        }
+        break;
+    }
+    case ColumnEncoding::IntRle:
+        while (decoded.size() < present) {
+            int value = static_cast<int>(in.get_signed());
+            size_t run = in.get_varint();
+            if (run == 0 || run > present - decoded.size()) {
+                throw std::runtime_error("Malformed run length in encoded block.");
+            }
+            decoded.insert(decoded.end(), run, Value(value));
+        }
+        break;
+    case ColumnEncoding::StringPlain:
+        for (size_t i = 0; i < present; ++i) decoded.emplace_back(in.get_string());
+        break;
+    case ColumnEncoding::StringDict: {
+        std::vector<std::string> dictionary(in.get_varint());
+        for (auto& entry : dictionary) entry = in.get_string();
+        unsigned width = in.get_byte();
+        if (width > 32) {
+            throw std::runtime_error("Malformed bit width in encoded block.");
+        }
+        for (uint32_t code : unpack_bits(in, present, width)) {
+            if (code >= dictionary.size()) {
+                throw std::runtime_error("Dictionary code out of range in encoded block.");
+            }
+            decoded.emplace_back(dictionary[code]);
+        }
+        break;
+    }
+    case ColumnEncoding::Tagged:
+        for (size_t i = 0; i < present; ++i) {
+            switch (in.get_byte()) {
+            case 'i': decoded.emplace_back(static_cast<int>(in.get_signed())); break;
+            case 'b': decoded.emplace_back(in.get_byte() != 0); break;
+            case 's': decoded.emplace_back(in.get_string()); break;
+            default: throw std::runtime_error("Unknown value tag in encoded block.");
+            }
+        }
+        break;
+    default:
+        throw std::runtime_error("Unknown column encoding: " + std::to_string(static_cast<int>(encoding)));
+    }
+
+    for (size_t i = 0, next = 0; i < count; ++i) {
+        if (validity[i]) {
+            values[i] = std::move(decoded[next++]);
+        }
+    }
+    return values;
+}
+
+ColumnEncoding block_encoding(const std::string& block) {
+    if (block.empty()) {
+        throw std::runtime_error("Empty encoded block.");
+    }
+    return static_cast<ColumnEncoding>(block[0]);
+}
+
+const char* encoding_name(ColumnEncoding encoding) {
+    switch (encoding) {
+    case ColumnEncoding::AllNull: return "all-null";
+    case ColumnEncoding::BoolBits: return "bool-bits";
+    case ColumnEncoding::BoolRle: return "bool-rle";
+    case ColumnEncoding::IntFor: return "int-for";
+    case ColumnEncoding::IntDelta: return "int-delta";
+    case ColumnEncoding::IntRle: return "int-rle";
+    case ColumnEncoding::StringPlain: return "string-plain";
+    case ColumnEncoding::StringDict: return "string-dict";
+    case ColumnEncoding::Tagged: return "tagged";
+    }
+    return "unknown";
+}
@@ -0,0 +1,64 @@
+#ifndef ENCODING_H
+#define ENCODING_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "value.h"
+
+//         .
+enum class ColumnEncoding : uint8_t {
+    AllNull = 0,
+    BoolBits = 1,     //  
+    BoolRle = 2,      //    
+    IntFor = 3,       //   ,     
+    IntDelta = 4,     //     varint
+    IntRle = 5,       //  (,  )
+    StringPlain = 6,  //     
+    StringDict = 7,   //       
+    Tagged = 8,       //      ( )
+};
+
+//      .
+class ByteWriter {
+public:
+    void put_byte(uint8_t value);
+    void put_varint(uint64_t value);
+    void put_signed(int64_t value);
+    void put_string(std::string_view value);
+    void put_bytes(const std::string& bytes);
+    const std::string& data() const { return buffer; }
+
+private:
+    std::string buffer;
+};
+
+//   ,  ByteWriter.
+class ByteReader {
+public:
+    explicit ByteReader(const std::string& data) : buffer(data) {}
+
+    uint8_t get_byte();
+    uint64_t get_varint();
+    int64_t get_signed();
+    std::string get_string();
+    std::string get_bytes(size_t count);
+    bool at_end() const { return pos >= buffer.size(); }
+
+private:
+    const std::string& buffer;
+    size_t pos = 0;
+};
+
+//     ,    .
+std::string encode_column_block(const std::vector<Value>& values);
+
+//  count    .
+std::vector<Value> decode_column_block(const std::string& block, size_t count);
+
+// ,    (  ).
+ColumnEncoding block_encoding(const std::string& block);
+const char* encoding_name(ColumnEncoding encoding);
+
+#endif // ENCODING_H
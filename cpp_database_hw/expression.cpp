@@ -0,0 +1,183 @@
+#include "expression.h"
+#include <cctype>
+#include <stdexcept>
+#include "planner.h"
+#include "utils.h"
+
+Expression Expression::literal(const Value& value) {
+    Expression result;
+    result.value = value;
+    return result;
+}
+
+namespace {
+
+//  : expr := term (('+'|'-') term)*, term := factor (('*'|'/'|'%') factor)*.
+class ExpressionParser {
+public:
+    explicit ExpressionParser(const std::string& text) : text(text) {}
+
+    Expression parse() {
+        Expression result = parse_sum();
+        skip_spaces();
+        if (pos != text.size()) {
+            throw std::runtime_error("Unexpected '" + text.substr(pos) + "' in expression: " + text);
+        }
+        return result;
+    }
+
+private:
+    const std::string& text;
+    size_t pos = 0;
+
+    void skip_spaces() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+            ++pos;
+        }
+    }
+
+    Expression binary(char op, Expression left, Expression right) {
+        Expression result;
+        result.kind = Expression::Kind::Binary;
+        result.op = op;
+        result.operands.push_back(std::move(left));
+        result.operands.push_back(std::move(right));
+        return result;
+    }
+
+    Expression parse_sum() {
+        Expression left = parse_product();
+        while (true) {
+            skip_spaces();
+            if (pos >= text.size() || (text[pos] != '+' && text[pos] != '-')) {
+                return left;
+            }
+            char op = text[pos++];
+            left = binary(op, std::move(left), parse_product());
+        }
+    }
+
+    Expression parse_product() {
+        Expression left = parse_operand();
+        while (true) {
+            skip_spaces();
+            if (pos >= text.size() || (text[pos] != '*' && text[pos] != '/' && text[pos] != '%')) {
+                return left;
+            }
+            char op = text[pos++];
+            left = binary(op, std::move(left), parse_operand());
+        }
+    }
+
+    Expression parse_operand() {
+        skip_spaces();
+        if (pos >= text.size()) {
+            throw std::runtime_error("Missing operand in expression: " + text);
+        }
+
+        char c = text[pos];
+        if (c == '(') {
+            ++pos;
+            Expression inner = parse_sum();
+            skip_spaces();
+            if (pos >= text.size() || text[pos] != ')') {
+                throw std::runtime_error("Missing ')' in expression: " + text);
+            }
+            ++pos;
+            return inner;
+        }
+        if (c == '\'') {
+            size_t end = text.find('\'', pos + 1);
+            if (end == std::string::npos) {
+                throw std::runtime_error("Unterminated string in expression: " + text);
+            }
+            std::string value = text.substr(pos + 1, end - pos - 1);
+            pos = end + 1;
+            return Expression::literal(value);
+        }
+        bool negative_number = (c == '-' && pos + 1 < text.size() && std::isdigit(static_cast<unsigned char>(text[pos + 1])));
+        if (std::isdigit(static_cast<unsigned char>(c)) || negative_number) {
+            size_t start = pos++;
+            while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos]))) {
+                ++pos;
+            }
+            return Expression::literal(std::stoi(text.substr(start, pos - start)));
+        }
+        if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+            size_t start = pos;
+            while (pos < text.size() && (std::isalnum(static_cast<unsigned char>(text[pos])) || text[pos] == '_')) {
+                ++pos;
+            }
+            std::string word = text.substr(start, pos - start);
+            if (word == "true" || word == "false") {
+                return Expression::literal(word == "true");
+            }
+            if (word == "NULL" || word == "null") {
+                return Expression::literal(Value());
+            }
+            Expression result;
+            result.kind = Expression::Kind::Column;
+            result.column = word;
+            return result;
+        }
+        throw std::runtime_error("Unexpected '" + std::string(1, c) + "' in expression: " + text);
+    }
+};
+
+}
+
+Expression parse_expression(const std::string& text) {
+    std::string trimmed = trim(text);
+    if (trimmed.empty()) {
+        throw std::runtime_error("Empty expression.");
+    }
+    return ExpressionParser(trimmed).parse();
+}
+
+std::vector<Assignment> parse_assignments(const std::string& text) {
+    std::vector<std::string> parts;
+    std::string current;
+    bool in_quotes = false;
+    for (char c : text) {
+        if (c == '\'') {
+            in_quotes = !in_quotes;
+        }
+        if (c == ',' && !in_quotes) {
+            parts.push_back(current);
+            current.clear();
+        }
+        else {
+            current += c;
+        }
+    }
+    parts.push_back(current);
+
+    std::vector<Assignment> assignments;
+    for (const auto& part : parts) {
+        auto equals_pos = part.find('=');
+        if (equals_pos == std::string::npos) {
+            throw std::runtime_error("Syntax error in UPDATE values: " + part);
+        }
+        Assignment assignment;
+        assignment.column = trim(part.substr(0, equals_pos));
+        if (assignment.column.empty()) {
+            throw std::runtime_error("Empty column name in UPDATE values.");
+        }
+        assignment.value = parse_expression(part.substr(equals_pos + 1));
+        assignments.push_back(std::move(assignment));
+    }
+    return assignments;
+}
+
+std::string expression_to_string(const Expression& expression) {
+    switch (expression.kind) {
+    case Expression::Kind::Literal:
+        return format_literal(expression.value);
+    case Expression::Kind::Column:
+        return expression.column;
+    case Expression::Kind::Binary:
+        return "(" + expression_to_string(expression.operands[0]) + " " + expression.op + " " +
+            expression_to_string(expression.operands[1]) + ")";
+    }
+    return "";
+}
@@ -0,0 +1,35 @@
+#ifndef EXPRESSION_H
+#define EXPRESSION_H
+
+#include <string>
+#include <vector>
+#include "value.h"
+
+//     SET: ,    
+//    (+ - * / %  int32, +  ).
+struct Expression {
+    enum class Kind { Literal, Column, Binary };
+
+    Kind kind = Kind::Literal;
+    Value value;                 //  Kind::Literal (  - NULL)
+    std::string column;             //  Kind::Column
+    char op = '+';                  //  Kind::Binary
+    std::vector<Expression> operands;
+
+    static Expression literal(const Value& value);
+};
+
+//   UPDATE:      .
+struct Assignment {
+    std::string column;
+    Expression value;
+};
+
+Expression parse_expression(const std::string& text);
+
+//   "col = expr, col2 = expr2" (    ).
+std::vector<Assignment> parse_assignments(const std::string& text);
+
+std::string expression_to_string(const Expression& expression);
+
+#endif // EXPRESSION_H
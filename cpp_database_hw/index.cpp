@@ -1,59 +1,627 @@
 #include "index.h"
 #include <stdexcept>
 #include <algorithm>
+#include <iterator>
 #include <typeinfo>
+#include "memory_usage.h"
+#include "planner.h"
+#include "utils.h"
 
-void Index::add_entry(const std::any& key, size_t row_index) {
-    if (key.type() == typeid(int)) {
-        int value = std::any_cast<int>(key);
-        int_index_data[value].push_back(row_index);
+//    ( ,   ).
+static std::vector<uint32_t> trigrams(const std::string& text) {
+    std::vector<uint32_t> result;
+    for (size_t i = 0; i + 3 <= text.size(); ++i) {
+        result.push_back((static_cast<uint32_t>(static_cast<unsigned char>(text[i])) << 16) |
+            (static_cast<uint32_t>(static_cast<unsigned char>(text[i + 1])) << 8) |
+            static_cast<uint32_t>(static_cast<unsigned char>(text[i + 2])));
     }
-    else if (key.type() == typeid(std::string)) {
-        std::string value = std::any_cast<std::string>(key);
-        string_index_data[value].push_back(row_index);
+    std::sort(result.begin(), result.end());
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+    return result;
+}
+
+//      32-.
+static uint32_t bitmap_position(size_t row_index) {
+    if (row_index > UINT32_MAX) {
+        throw std::runtime_error("Bitmap index supports up to 2^32 rows.");
+    }
+    return static_cast<uint32_t>(row_index);
+}
+
+//     removed:  ,  
+//     .     .
+static void compact_positions(std::vector<size_t>& positions, const std::vector<size_t>& removed) {
+    auto first = std::lower_bound(positions.begin(), positions.end(), removed.front());
+    auto out = first;
+    size_t r = 0;
+    for (auto it = first; it != positions.end(); ++it) {
+        while (r < removed.size() && removed[r] < *it) {
+            ++r;
+        }
+        if (r < removed.size() && removed[r] == *it) {
+            continue;
+        }
+        *out++ = *it - r;
+    }
+    positions.erase(out, positions.end());
+}
+
+static RoaringBitmap compact_bitmap(const RoaringBitmap& bitmap, const std::vector<size_t>& removed) {
+    std::vector<size_t> positions = bitmap.to_positions();
+    compact_positions(positions, removed);
+    RoaringBitmap result;
+    for (size_t position : positions) {
+        result.add(static_cast<uint32_t>(position));
+    }
+    return result;
+}
+
+//     ;      .
+static void insert_position(std::vector<size_t>& positions, size_t row_index) {
+    if (positions.empty() || positions.back() < row_index) {
+        positions.push_back(row_index);
+    }
+    else {
+        positions.insert(std::upper_bound(positions.begin(), positions.end(), row_index), row_index);
+    }
+}
+
+//  ,    :      .
+static size_t key_shard(const Value& key) {
+    return static_cast<size_t>(stable_hash(key) % INDEX_SHARDS);
+}
+
+static size_t trigram_shard(uint32_t trigram) {
+    return static_cast<size_t>((trigram * 2654435761u) >> 26) % INDEX_SHARDS;
+}
+
+Index::Shard& Index::writable_shard(size_t shard) {
+    auto& data = shards[shard];
+    if (!data) {
+        data = std::make_shared<Shard>();
+    }
+    else if (data.use_count() > 1) {
+        data = std::make_shared<Shard>(*data);
+    }
+    return *data;
+}
+
+RoaringBitmap& Index::writable_non_null_rows() {
+    if (!non_null_rows) {
+        non_null_rows = std::make_shared<RoaringBitmap>();
+    }
+    else if (non_null_rows.use_count() > 1) {
+        non_null_rows = std::make_shared<RoaringBitmap>(*non_null_rows);
+    }
+    return *non_null_rows;
+}
+
+void Index::add_entry(const Value& key, size_t row_index) {
+    if (index_kind == IndexKind::Bitmap) {
+        if (!key.has_value()) {
+            throw std::invalid_argument("Unsupported key type for indexing.");
+        }
+        uint32_t position = bitmap_position(row_index);
+        writable_shard(key_shard(key)).bitmaps[key].add(position);
+        writable_non_null_rows().add(position);
+        return;
+    }
+    if (key.is_int()) {
+        int value = key.as_int();
+        insert_position(writable_shard(key_shard(key)).int_index_data[value], row_index);
+    }
+    else if (key.is_string()) {
+        std::string value(key.as_string());
+        Shard& shard = writable_shard(key_shard(key));
+        insert_position(shard.string_index_data[value], row_index);
+        if (index_kind == IndexKind::Text) {
+            shard.sorted_keys.insert(value);
+            for (uint32_t trigram : trigrams(value)) {
+                insert_position(writable_shard(trigram_shard(trigram)).trigram_postings[trigram], row_index);
+            }
+        }
     }
     else {
         throw std::invalid_argument("Unsupported key type for indexing.");
     }
 }
 
-std::vector<size_t> Index::find(const std::any& key) const {
-    if (key.type() == typeid(int)) {
-        int value = std::any_cast<int>(key);
-        if (int_index_data.find(value) != int_index_data.end()) {
-            return int_index_data.at(value);
+std::vector<size_t> Index::find_like(const std::string& pattern) const {
+    if (index_kind != IndexKind::Text) {
+        throw std::logic_error("LIKE search needs a text index.");
+    }
+    if (!like_has_wildcards(pattern)) {
+        auto rows = find(pattern);
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    }
+
+    std::vector<size_t> result;
+    std::string prefix = like_prefix(pattern);
+    if (!prefix.empty()) {
+        //           
+        for (const auto& shard : shards) {
+            if (!shard) {
+                continue;
+            }
+            for (auto it = shard->sorted_keys.lower_bound(prefix); it != shard->sorted_keys.end() && it->compare(0, prefix.size(), prefix) == 0; ++it) {
+                const auto& rows = shard->string_index_data.at(*it);
+                result.insert(result.end(), rows.begin(), rows.end());
+            }
         }
+        std::sort(result.begin(), result.end());
+        return result;
     }
-    else if (key.type() == typeid(std::string)) {
-        std::string value = std::any_cast<std::string>(key);
-        if (string_index_data.find(value) != string_index_data.end()) {
-            return string_index_data.at(value);
+
+    //       ,    
+    std::vector<const std::vector<size_t>*> lists;
+    for (const auto& fragment : like_fragments(pattern)) {
+        for (uint32_t trigram : trigrams(fragment)) {
+            const auto& shard = shards[trigram_shard(trigram)];
+            if (!shard) {
+                return {};
+            }
+            auto it = shard->trigram_postings.find(trigram);
+            if (it == shard->trigram_postings.end()) {
+                return {};
+            }
+            lists.push_back(&it->second);
+        }
+    }
+    if (lists.empty()) {
+        throw std::logic_error("LIKE pattern has no prefix or trigram to search: " + pattern);
+    }
+    std::sort(lists.begin(), lists.end(), [](const auto* a, const auto* b) { return a->size() < b->size(); });
+    result = *lists[0];
+    for (size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+        std::vector<size_t> narrowed;
+        std::set_intersection(result.begin(), result.end(), lists[i]->begin(), lists[i]->end(), std::back_inserter(narrowed));
+        result = std::move(narrowed);
+    }
+    return result;
+}
+
+std::vector<size_t> Index::find(const Value& key) const {
+    if (!key.has_value()) {
+        return {};
+    }
+    const auto& shard = shards[key_shard(key)];
+    if (!shard) {
+        return {};
+    }
+    if (index_kind == IndexKind::Bitmap) {
+        if (!bitmap_key_type(key)) {
+            return {};
+        }
+        auto it = shard->bitmaps.find(key);
+        return it != shard->bitmaps.end() ? it->second.to_positions() : std::vector<size_t>();
+    }
+    if (key.is_int()) {
+        auto it = shard->int_index_data.find(key.as_int());
+        if (it != shard->int_index_data.end()) {
+            return it->second;
+        }
+    }
+    else if (key.is_string()) {
+        auto it = shard->string_index_data.find(std::string(key.as_string()));
+        if (it != shard->string_index_data.end()) {
+            return it->second;
         }
     }
     return {};
 }
 
-void Index::remove_entry(const std::any& key, size_t row_index) {
-    if (key.type() == typeid(int)) {
-        int value = std::any_cast<int>(key);
-        auto it = int_index_data.find(value);
-        if (it != int_index_data.end()) {
+void Index::remove_entry(const Value& key, size_t row_index) {
+    if (!key.has_value() || !shards[key_shard(key)]) {
+        return;
+    }
+    if (index_kind == IndexKind::Bitmap) {
+        if (!bitmap_key_type(key) || row_index > UINT32_MAX) {
+            return;
+        }
+        Shard& shard = writable_shard(key_shard(key));
+        auto it = shard.bitmaps.find(key);
+        if (it != shard.bitmaps.end()) {
+            it->second.remove(static_cast<uint32_t>(row_index));
+            writable_non_null_rows().remove(static_cast<uint32_t>(row_index));
+            if (it->second.empty()) {
+                shard.bitmaps.erase(it);
+            }
+        }
+        return;
+    }
+    Shard& shard = writable_shard(key_shard(key));
+    if (key.is_int()) {
+        int value = key.as_int();
+        auto it = shard.int_index_data.find(value);
+        if (it != shard.int_index_data.end()) {
             auto& vec = it->second;
             vec.erase(std::remove(vec.begin(), vec.end(), row_index), vec.end());
             if (vec.empty()) {
-                int_index_data.erase(it);
+                shard.int_index_data.erase(it);
             }
         }
     }
-    else if (key.type() == typeid(std::string)) {
-        std::string value = std::any_cast<std::string>(key);
-        auto it = string_index_data.find(value);
-        if (it != string_index_data.end()) {
+    else if (key.is_string()) {
+        std::string value(key.as_string());
+        auto it = shard.string_index_data.find(value);
+        if (it != shard.string_index_data.end()) {
             auto& vec = it->second;
             vec.erase(std::remove(vec.begin(), vec.end(), row_index), vec.end());
             if (vec.empty()) {
-                string_index_data.erase(it);
+                shard.string_index_data.erase(it);
+                shard.sorted_keys.erase(value);
+            }
+        }
+        if (index_kind == IndexKind::Text) {
+            for (uint32_t trigram : trigrams(value)) {
+                if (!shards[trigram_shard(trigram)]) {
+                    continue;
+                }
+                auto& trigram_postings = writable_shard(trigram_shard(trigram)).trigram_postings;
+                auto postings_it = trigram_postings.find(trigram);
+                if (postings_it == trigram_postings.end()) {
+                    continue;
+                }
+                auto& postings = postings_it->second;
+                auto pos = std::lower_bound(postings.begin(), postings.end(), row_index);
+                if (pos != postings.end() && *pos == row_index) {
+                    postings.erase(pos);
+                }
+                if (postings.empty()) {
+                    trigram_postings.erase(postings_it);
+                }
+            }
+        }
+    }
+}
+
+//   from  to   .
+static void replace_position(std::vector<size_t>& positions, size_t from, size_t to) {
+    auto it = std::lower_bound(positions.begin(), positions.end(), from);
+    if (it != positions.end() && *it == from) {
+        *it = to;
+    }
+}
+
+void Index::move_entry(const Value& key, size_t from, size_t to) {
+    if (!key.has_value() || !shards[key_shard(key)]) {
+        return;
+    }
+    if (index_kind == IndexKind::Bitmap) {
+        if (!bitmap_key_type(key)) {
+            return;
+        }
+        Shard& shard = writable_shard(key_shard(key));
+        auto it = shard.bitmaps.find(key);
+        if (it != shard.bitmaps.end()) {
+            it->second.remove(bitmap_position(from));
+            it->second.add(bitmap_position(to));
+            RoaringBitmap& non_null = writable_non_null_rows();
+            non_null.remove(bitmap_position(from));
+            non_null.add(bitmap_position(to));
+        }
+        return;
+    }
+    Shard& shard = writable_shard(key_shard(key));
+    if (key.is_int()) {
+        auto it = shard.int_index_data.find(key.as_int());
+        if (it != shard.int_index_data.end()) {
+            replace_position(it->second, from, to);
+        }
+    }
+    else if (key.is_string()) {
+        std::string value(key.as_string());
+        auto it = shard.string_index_data.find(value);
+        if (it != shard.string_index_data.end()) {
+            replace_position(it->second, from, to);
+        }
+        if (index_kind == IndexKind::Text) {
+            for (uint32_t trigram : trigrams(value)) {
+                if (!shards[trigram_shard(trigram)]) {
+                    continue;
+                }
+                auto& trigram_postings = writable_shard(trigram_shard(trigram)).trigram_postings;
+                auto postings = trigram_postings.find(trigram);
+                if (postings != trigram_postings.end()) {
+                    replace_position(postings->second, from, to);
+                }
+            }
+        }
+    }
+}
+
+void Index::erase_rows(const std::vector<size_t>& removed) {
+    if (removed.empty()) {
+        return;
+    }
+    auto compact_map = [&](auto& map) {
+        for (auto it = map.begin(); it != map.end();) {
+            if (!it->second.empty() && it->second.back() >= removed.front()) {
+                compact_positions(it->second, removed);
+            }
+            it = it->second.empty() ? map.erase(it) : std::next(it);
+        }
+        };
+    //     ,     
+    for (size_t s = 0; s < INDEX_SHARDS; ++s) {
+        if (!shards[s]) {
+            continue;
+        }
+        Shard& shard = writable_shard(s);
+        compact_map(shard.int_index_data);
+        for (auto it = shard.string_index_data.begin(); it != shard.string_index_data.end();) {
+            if (!it->second.empty() && it->second.back() >= removed.front()) {
+                compact_positions(it->second, removed);
+            }
+            if (it->second.empty()) {
+                shard.sorted_keys.erase(it->first);
+                it = shard.string_index_data.erase(it);
+            }
+            else {
+                ++it;
+            }
+        }
+        compact_map(shard.trigram_postings);
+
+        for (auto it = shard.bitmaps.begin(); it != shard.bitmaps.end();) {
+            it->second = compact_bitmap(it->second, removed);
+            it = it->second.empty() ? shard.bitmaps.erase(it) : std::next(it);
+        }
+    }
+    if (index_kind == IndexKind::Bitmap && non_null_rows) {
+        non_null_rows = std::make_shared<RoaringBitmap>(compact_bitmap(*non_null_rows, removed));
+    }
+}
+
+bool Index::bitmap_key_type(const Value& key) const {
+    //              
+    if (!key.has_value()) {
+        return false;
+    }
+    for (const auto& shard : shards) {
+        if (shard && !shard->bitmaps.empty()) {
+            return shard->bitmaps.begin()->first.same_type(key);
+        }
+    }
+    return false;
+}
+
+RoaringBitmap Index::find_bitmap(CompareOp op, const Value& value, size_t row_count) const {
+    if (index_kind != IndexKind::Bitmap) {
+        throw std::logic_error("Bitmap search needs a bitmap index.");
+    }
+    RoaringBitmap non_null = non_null_rows ? *non_null_rows : RoaringBitmap();
+    if (!value.has_value()) {
+        // "col=NULL" -  , "col!=NULL" - 
+        return op == CompareOp::Eq ? RoaringBitmap::range(bitmap_position(row_count)) - non_null : non_null;
+    }
+    if (op == CompareOp::Eq) {
+        const auto& shard = shards[key_shard(value)];
+        if (!shard || !bitmap_key_type(value)) {
+            return RoaringBitmap();
+        }
+        auto it = shard->bitmaps.find(value);
+        return it != shard->bitmaps.end() ? it->second : RoaringBitmap();
+    }
+
+    //  ,       ,    
+    RoaringBitmap result;
+    for (const auto& shard : shards) {
+        if (!shard) {
+            continue;
+        }
+        for (const auto& [key, rows] : shard->bitmaps) {
+            bool matches = (op == CompareOp::Like)
+                ? key.is_string() && value.is_string() && like_matches(value.as_string(), key.as_string())
+                : values_comparable(key, value) && compare_matches(op, compare_values(key, value));
+            if (matches) {
+                result |= rows;
+            }
+        }
+    }
+    return result;
+}
+
+//    -; value_bytes -     .
+template <typename Map, typename ValueBytes>
+static size_t hash_map_bytes(const Map& map, ValueBytes value_bytes) {
+    size_t bytes = map.bucket_count() * sizeof(void*);
+    for (const auto& entry : map) {
+        bytes += HASH_NODE_BYTES + sizeof(entry) + value_bytes(entry);
+    }
+    return bytes;
+}
+
+size_t Index::memory_bytes() const {
+    size_t bytes = 0;
+    for (const auto& shard : shards) {
+        if (!shard) {
+            continue;
+        }
+        bytes += sizeof(Shard);
+        bytes += hash_map_bytes(shard->string_index_data, [](const auto& entry) {
+            return string_heap_bytes(entry.first) + vector_bytes(entry.second);
+            });
+        bytes += hash_map_bytes(shard->int_index_data, [](const auto& entry) { return vector_bytes(entry.second); });
+        bytes += hash_map_bytes(shard->trigram_postings, [](const auto& entry) { return vector_bytes(entry.second); });
+        for (const auto& key : shard->sorted_keys) {
+            bytes += TREE_NODE_BYTES + sizeof(key) + string_heap_bytes(key);
+        }
+        for (const auto& entry : shard->bitmaps) {
+            bytes += TREE_NODE_BYTES + sizeof(entry) + entry.first.heap_bytes() + entry.second.memory_bytes();
+        }
+    }
+    return bytes + (non_null_rows ? non_null_rows->memory_bytes() : 0);
+}
+
+CompositeIndex::CompositeIndex(std::vector<size_t> key_columns, std::vector<size_t> included_columns, size_t column_count)
+    : key_ordinals(std::move(key_columns)), included_ordinals(std::move(included_columns)), covered(column_count, false) {
+    for (size_t column : key_ordinals) {
+        covered.at(column) = true;
+    }
+    for (size_t column : included_ordinals) {
+        covered.at(column) = true;
+    }
+}
+
+std::vector<Value> CompositeIndex::key_of(const std::vector<Value>& row) const {
+    std::vector<Value> key;
+    key.reserve(key_ordinals.size());
+    for (size_t column : key_ordinals) {
+        key.push_back(row[column]);
+    }
+    return key;
+}
+
+CompositeIndex::EntryMap& CompositeIndex::writable_shard(size_t shard) {
+    auto& entries = shards[shard];
+    if (!entries) {
+        entries = std::make_shared<EntryMap>();
+    }
+    else if (entries.use_count() > 1) {
+        entries = std::make_shared<EntryMap>(*entries);
+    }
+    return *entries;
+}
+
+void CompositeIndex::add_entry(const std::vector<Value>& row, size_t row_index) {
+    std::vector<Value> key = key_of(row);
+    EntryMap& entries = writable_shard(key_shard(key[0]));
+    std::vector<Value> image(row.size());
+    for (size_t column = 0; column < row.size(); ++column) {
+        if (covered[column]) {
+            image[column] = row[column];
+        }
+    }
+    entries[std::move(key)].push_back({ row_index, std::move(image) });
+}
+
+void CompositeIndex::remove_entry(const std::vector<Value>& row, size_t row_index) {
+    std::vector<Value> key = key_of(row);
+    if (!shards[key_shard(key[0])]) {
+        return;
+    }
+    EntryMap& entries = writable_shard(key_shard(key[0]));
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return;
+    }
+    auto& list = it->second;
+    list.erase(std::remove_if(list.begin(), list.end(), [&](const Entry& entry) { return entry.row_index == row_index; }), list.end());
+    if (list.empty()) {
+        entries.erase(it);
+    }
+}
+
+void CompositeIndex::move_entry(const std::vector<Value>& row, size_t from, size_t to) {
+    std::vector<Value> key = key_of(row);
+    if (!shards[key_shard(key[0])]) {
+        return;
+    }
+    EntryMap& entries = writable_shard(key_shard(key[0]));
+    auto it = entries.find(key);
+    if (it == entries.end()) {
+        return;
+    }
+    for (auto& entry : it->second) {
+        if (entry.row_index == from) {
+            entry.row_index = to;
+            return;
+        }
+    }
+}
+
+void CompositeIndex::erase_rows(const std::vector<size_t>& removed) {
+    if (removed.empty()) {
+        return;
+    }
+    for (size_t s = 0; s < INDEX_SHARDS; ++s) {
+        if (!shards[s]) {
+            continue;
+        }
+        EntryMap& entries = writable_shard(s);
+        for (auto it = entries.begin(); it != entries.end();) {
+            auto& list = it->second;
+            auto out = list.begin();
+            for (auto& entry : list) {
+                auto r = std::lower_bound(removed.begin(), removed.end(), entry.row_index);
+                if (r != removed.end() && *r == entry.row_index) {
+                    continue;
+                }
+                entry.row_index -= static_cast<size_t>(r - removed.begin());
+                if (&*out != &entry) {
+                    *out = std::move(entry);
+                }
+                ++out;
+            }
+            list.erase(out, list.end());
+            it = list.empty() ? entries.erase(it) : std::next(it);
+        }
+    }
+}
+
+template <typename Visit>
+void CompositeIndex::visit_prefix(const std::vector<Value>& prefix, Visit visit) const {
+    if (prefix.empty() || prefix.size() > key_ordinals.size()) {
+        throw std::logic_error("Composite index prefix must have 1 to " + std::to_string(key_ordinals.size()) + " values.");
+    }
+    //               :
+    //     
+    const auto& entries = shards[key_shard(prefix[0])];
+    if (!entries) {
+        return;
+    }
+    for (auto it = entries->lower_bound(prefix); it != entries->end(); ++it) {
+        for (size_t i = 0; i < prefix.size(); ++i) {
+            if (compare_cells(it->first[i], prefix[i]) != 0) {
+                return;
+            }
+        }
+        for (const auto& entry : it->second) {
+            visit(entry);
+        }
+    }
+}
+
+std::vector<size_t> CompositeIndex::find(const std::vector<Value>& prefix) const {
+    std::vector<size_t> result;
+    visit_prefix(prefix, [&](const Entry& entry) { result.push_back(entry.row_index); });
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<const std::vector<Value>*> CompositeIndex::find_images(const std::vector<Value>& prefix) const {
+    std::vector<const Entry*> matched;
+    visit_prefix(prefix, [&](const Entry& entry) { matched.push_back(&entry); });
+    std::sort(matched.begin(), matched.end(), [](const Entry* a, const Entry* b) { return a->row_index < b->row_index; });
+    std::vector<const std::vector<Value>*> result;
+    result.reserve(matched.size());
+    for (const Entry* entry : matched) {
+        result.push_back(&entry->image);
+    }
+    return result;
+}
+
+size_t CompositeIndex::memory_bytes() const {
+    size_t bytes = vector_bytes(key_ordinals) + vector_bytes(included_ordinals) + covered.capacity() / 8;
+    for (const auto& entries : shards) {
+        if (!entries) {
+            continue;
+        }
+        bytes += sizeof(EntryMap);
+        for (const auto& [key, rows] : *entries) {
+            bytes += TREE_NODE_BYTES + sizeof(key) + sizeof(rows) + vector_bytes(key) + vector_bytes(rows);
+            for (const auto& value : key) {
+                bytes += value.heap_bytes();
+            }
+            for (const auto& entry : rows) {
+                bytes += vector_bytes(entry.image);
+                for (const auto& value : entry.image) {
+                    bytes += value.heap_bytes();
+                }
             }
         }
     }
+    return bytes;
 }
@@ -1,18 +1,130 @@
 #pragma once
 #include <unordered_map>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <set>
 #include <vector>
-#include <any>
 #include <string>
+#include "bitmap.h"
+#include "planner.h"
+#include "value.h"
+
+// Hash -   ; Text -     
+//         (LIKE); Bitmap -  
+//     ,       .
+enum class IndexKind { Hash, Text, Bitmap };
+
+//  ,     .
+const size_t INDEX_SHARDS = 64;
 
 class Index {
 private:
-    std::unordered_map<std::string, std::vector<size_t>> string_index_data;
-    std::unordered_map<int, std::vector<size_t>> int_index_data;
+    IndexKind index_kind = IndexKind::Hash;
+
+    struct CellLess {
+        bool operator()(const Value& left, const Value& right) const { return compare_cells(left, right) < 0; }
+    };
+    //    (  ;   -   ).
+    struct Shard {
+        std::unordered_map<std::string, std::vector<size_t>> string_index_data;
+        std::unordered_map<int, std::vector<size_t>> int_index_data;
+
+        //   IndexKind::Text
+        std::set<std::string> sorted_keys;
+        std::unordered_map<uint32_t, std::vector<size_t>> trigram_postings; //    
+
+        //   IndexKind::Bitmap
+        std::map<Value, RoaringBitmap, CellLess> bitmaps;
+    };
+    //   (, )  ,    
+    //    .    .
+    std::array<std::shared_ptr<Shard>, INDEX_SHARDS> shards;
+    std::shared_ptr<RoaringBitmap> non_null_rows;  //   IndexKind::Bitmap
+    Shard& writable_shard(size_t shard);
+    RoaringBitmap& writable_non_null_rows();
+    bool bitmap_key_type(const Value& key) const;
 
 public:
-    void add_entry(const std::any& key, size_t row_index);
+    Index() = default;
+    explicit Index(IndexKind kind) : index_kind(kind) {}
+
+    IndexKind kind() const { return index_kind; }
+
+    void add_entry(const Value& key, size_t row_index);
+
+    std::vector<size_t> find(const Value& key) const;
+
+    //  ,     LIKE ( ).
+    //    :    
+    //    .   IndexKind::Text.
+    std::vector<size_t> find_like(const std::string& pattern) const;
+
+    void remove_entry(const Value& key, size_t row_index);
+
+    //    key    from  to < from.   
+    //       from,    .
+    void move_entry(const Value& key, size_t from, size_t to);
+
+    //   removed (  )    
+    //  ,      .
+    void erase_rows(const std::vector<size_t>& removed);
+
+    //    row_count,      value,   
+    // ,     (value   -   NULL).
+    //   IndexKind::Bitmap.
+    RoaringBitmap find_bitmap(CompareOp op, const Value& value, size_t row_count) const;
+
+    //     .
+    size_t memory_bytes() const;
+};
+
+//     ,     (INCLUDE).
+//  ,        .  
+//        ,     
+//   ( - NULL): ,   ,   .
+class CompositeIndex {
+private:
+    std::vector<size_t> key_ordinals;       //     
+    std::vector<size_t> included_ordinals;  //   
+    std::vector<bool> covered;              //  ,    
+
+    struct Entry {
+        size_t row_index;
+        std::vector<Value> image;
+    };
+    // NULL   :       .
+    //    Index,     (    ,  
+    //      ),      .
+    using EntryMap = std::map<std::vector<Value>, std::vector<Entry>, RowLess>;
+    std::array<std::shared_ptr<EntryMap>, INDEX_SHARDS> shards;
+    EntryMap& writable_shard(size_t shard);
+
+    template <typename Visit>
+    void visit_prefix(const std::vector<Value>& prefix, Visit visit) const;
+
+public:
+    CompositeIndex() = default;
+    CompositeIndex(std::vector<size_t> key_columns, std::vector<size_t> included_columns, size_t column_count);
+
+    const std::vector<size_t>& key_columns() const { return key_ordinals; }
+    const std::vector<size_t>& included_columns() const { return included_ordinals; }
+    bool covers(size_t column) const { return column < covered.size() && covered[column]; }
+    //  :   .
+    std::vector<Value> key_of(const std::vector<Value>& row) const;
+
+    void add_entry(const std::vector<Value>& row, size_t row_index);
+    void remove_entry(const std::vector<Value>& row, size_t row_index);
+    //  Index::move_entry  Index::erase_rows.
+    void move_entry(const std::vector<Value>& row, size_t from, size_t to);
+    void erase_rows(const std::vector<size_t>& removed);
+    void clear() { shards = {}; }
 
-    std::vector<size_t> find(const std::any& key) const;
+    //   ( ),    prefix.size()    prefix.
+    std::vector<size_t> find(const std::vector<Value>& prefix) const;
+    //        .
+    std::vector<const std::vector<Value>*> find_images(const std::vector<Value>& prefix) const;
 
-    void remove_entry(const std::any& key, size_t row_index);
+    size_t memory_bytes() const;
 };
@@ -3,7 +3,57 @@
 #include <fstream>
 #include <string>
 
-int main() {
+// replay <> < > [--fast] [--speed <k>] [--concurrency <n>]
+//  ,  Database::start_capture,     save_to_file
+//      .
+static int run_replay(int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " replay <snapshot> <workload log> [--fast] [--speed <k>] [--concurrency <n>]\n";
+        return 2;
+    }
+    try {
+        ReplayOptions options;
+        for (int i = 4; i < argc; ++i) {
+            std::string option = argv[i];
+            if (option == "--fast") {
+                options.original_pacing = false;
+            }
+            else if (option == "--speed" && i + 1 < argc) {
+                options.speed = std::stod(argv[++i]);
+            }
+            else if (option == "--concurrency" && i + 1 < argc) {
+                options.concurrency = std::stoul(argv[++i]);
+            }
+            else {
+                throw std::runtime_error("Unknown replay option: " + option);
+            }
+        }
+
+        Database db;
+        db.load_from_file(argv[2]);
+        std::vector<WorkloadEntry> entries = read_workload(argv[3]);
+
+        //       
+        std::cout.setstate(std::ios::failbit);
+        std::cerr.setstate(std::ios::failbit);
+        ReplayReport report = replay_workload(db, entries, options);
+        std::cout.clear();
+        std::cerr.clear();
+        std::cout << format_replay_report(report);
+    }
+    catch (const std::exception& e) {
+        std::cout.clear();
+        std::cerr.clear();
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "replay") {
+        return run_replay(argc, argv);
+    }
     try {
         Database db;
 
@@ -26,14 +76,10 @@ int main() {
         db.save_to_file("db.bin");
         std::cout << "Data saved to file.\n";
 
-        //    
-        std::ifstream file("db.bin");
+        //     ( ,   )
+        std::ifstream file("db.bin", std::ios::binary | std::ios::ate);
         if (file.is_open()) {
-            std::cout << "File content (db.bin):" << std::endl;
-            std::string line;
-            while (std::getline(file, line)) {
-                std::cout << line << std::endl;
-            }
+            std::cout << "File size (db.bin): " << file.tellg() << " bytes" << std::endl;
             file.close();
         }
         else {
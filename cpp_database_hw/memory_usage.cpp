@@ -0,0 +1,51 @@
+#include "memory_usage.h"
+#include <sstream>
+
+size_t TableMemory::total() const {
+    size_t result = row_bytes + zone_map_bytes;
+    for (const auto& [name, bytes] : index_bytes) {
+        result += bytes;
+    }
+    return result;
+}
+
+size_t MemoryReport::total() const {
+    size_t result = result_cache_bytes;
+    for (const auto& [name, table] : tables) {
+        result += table.total();
+    }
+    for (size_t bytes : transactions) {
+        result += bytes;
+    }
+    for (const auto& query : queries) {
+        result += query.bytes;
+    }
+    return result;
+}
+
+static std::string format_limit(size_t bytes) {
+    return bytes ? std::to_string(bytes) : std::string("none");
+}
+
+std::string format_memory_report(const MemoryReport& report) {
+    std::ostringstream out;
+    for (const auto& [name, table] : report.tables) {
+        out << "table: " << name << ", bytes: " << table.total()
+            << " (rows: " << table.row_bytes << ", zone map: " << table.zone_map_bytes << ")\n";
+        for (const auto& [index, bytes] : table.index_bytes) {
+            out << "  index: " << index << ", bytes: " << bytes << "\n";
+        }
+    }
+    for (size_t level = 0; level < report.transactions.size(); ++level) {
+        out << "transaction: " << (level + 1) << ", bytes: " << report.transactions[level] << "\n";
+    }
+    for (const auto& query : report.queries) {
+        out << "query: " << query.query << ", bytes: " << query.bytes
+            << ", limit: " << format_limit(query.limit) << ", running: " << query.running.count() << " ms\n";
+    }
+    out << "result cache: " << report.result_cache_bytes << " bytes\n";
+    out << "limits: query " << format_limit(report.limits.query_bytes)
+        << ", transaction " << format_limit(report.limits.transaction_bytes) << "\n";
+    out << "total: " << report.total() << " bytes\n";
+    return out.str();
+}
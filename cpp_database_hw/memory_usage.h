@@ -0,0 +1,65 @@
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include <chrono>
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+//        ;  
+//    - -   64- .
+const size_t TREE_NODE_BYTES = 32;   //  std::map/std::set    
+const size_t HASH_NODE_BYTES = 16;   //  std::unordered_map    
+
+template <typename T>
+size_t vector_bytes(const std::vector<T>& values) {
+    return values.capacity() * sizeof(T);
+}
+
+//     (     ).
+inline size_t string_heap_bytes(const std::string& text) {
+    return text.capacity() > 15 ? text.capacity() + 1 : 0;
+}
+
+//   (  -   ).
+struct TableMemory {
+    size_t row_bytes = 0;                       //    
+    size_t zone_map_bytes = 0;
+    std::map<std::string, size_t> index_bytes;  //       "a,b"
+
+    size_t total() const;
+};
+
+//  ; 0 -  .
+struct MemoryLimits {
+    // ,     (,  , 
+    // ):     . ORDER BY   
+    //   ,    .
+    size_t query_bytes = 0;
+    //  ,      : ,
+    // -     ,    .
+    size_t transaction_bytes = 0;
+};
+
+struct QueryMemory {
+    std::string query;
+    size_t bytes = 0;
+    size_t limit = 0;
+    std::chrono::milliseconds running{ 0 };
+};
+
+struct MemoryReport {
+    std::map<std::string, TableMemory> tables;
+    std::vector<size_t> transactions;   //     ,  
+    std::vector<QueryMemory> queries;   //  
+    size_t result_cache_bytes = 0;
+    MemoryLimits limits;
+
+    size_t total() const;
+};
+
+//  SHOW MEMORY.
+std::string format_memory_report(const MemoryReport& report);
+
+#endif // MEMORY_USAGE_H
@@ -0,0 +1,177 @@
+#include "partition.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include "utils.h"
+
+namespace {
+
+//   ,  value (upper)    value (lower).
+size_t bound_position(const PartitionScheme& scheme, const Value& value, bool upper) {
+    auto less = [](const Value& left, const Value& right) { return compare_values(left, right) < 0; };
+    auto it = upper
+        ? std::upper_bound(scheme.range_bounds.begin(), scheme.range_bounds.end(), value, less)
+        : std::lower_bound(scheme.range_bounds.begin(), scheme.range_bounds.end(), value, less);
+    return static_cast<size_t>(it - scheme.range_bounds.begin());
+}
+
+std::vector<bool> prune_mask(const PartitionScheme& scheme, const Condition& condition) {
+    size_t count = partition_count(scheme);
+    std::vector<bool> all(count, true), none(count, false);
+    switch (condition.kind) {
+    case Condition::Kind::Constant:
+        return condition.constant ? all : none;
+    case Condition::Kind::Not:
+        //     
+        return all;
+    case Condition::Kind::And:
+    case Condition::Kind::Or: {
+        bool is_and = (condition.kind == Condition::Kind::And);
+        std::vector<bool> mask = is_and ? all : none;
+        for (const auto& child : condition.children) {
+            std::vector<bool> part = prune_mask(scheme, child);
+            for (size_t i = 0; i < count; ++i) {
+                mask[i] = is_and ? (mask[i] && part[i]) : (mask[i] || part[i]);
+            }
+        }
+        return mask;
+    }
+    case Condition::Kind::Compare:
+        break;
+    }
+
+    if (condition.column != scheme.column) {
+        return all;
+    }
+    const Value& value = condition.value;
+    if (!value.has_value()) {
+        // "col=NULL"   ,      
+        if (condition.op != CompareOp::Eq) {
+            return all;
+        }
+        std::vector<bool> mask = none;
+        mask[0] = true;
+        return mask;
+    }
+    if (condition.op == CompareOp::Ne || condition.op == CompareOp::Like) {
+        return all;
+    }
+
+    std::vector<bool> mask = none;
+    if (scheme.kind == PartitionScheme::Kind::Hash) {
+        if (condition.op != CompareOp::Eq) {
+            return all;
+        }
+        mask[partition_of(scheme, value)] = true;
+        return mask;
+    }
+
+    //  p    [range_bounds[p - 1], range_bounds[p])
+    size_t first = 0, last = count - 1;
+    switch (condition.op) {
+    case CompareOp::Eq:
+        first = last = bound_position(scheme, value, true);
+        break;
+    case CompareOp::Lt:
+        last = bound_position(scheme, value, false);
+        break;
+    case CompareOp::Le:
+        last = bound_position(scheme, value, true);
+        break;
+    case CompareOp::Gt:
+    case CompareOp::Ge:
+        first = bound_position(scheme, value, true);
+        break;
+    default:
+        return all;
+    }
+    for (size_t i = first; i <= last; ++i) {
+        mask[i] = true;
+    }
+    return mask;
+}
+
+}
+
+size_t partition_count(const PartitionScheme& scheme) {
+    switch (scheme.kind) {
+    case PartitionScheme::Kind::Hash: return scheme.hash_partitions;
+    case PartitionScheme::Kind::Range: return scheme.range_bounds.size() + 1;
+    case PartitionScheme::Kind::None: break;
+    }
+    return 0;
+}
+
+void validate_partitioning(const PartitionScheme& scheme, const std::map<std::string, std::string>& column_types) {
+    if (scheme.kind == PartitionScheme::Kind::None) {
+        return;
+    }
+    auto it = column_types.find(scheme.column);
+    if (it == column_types.end()) {
+        throw std::runtime_error("Partition column " + scheme.column + " not found.");
+    }
+    const std::string& type = it->second;
+    if (type != "int32" && type != "string") {
+        throw std::runtime_error("Partition column " + scheme.column + " of type '" + type + "' is not supported.");
+    }
+
+    if (scheme.kind == PartitionScheme::Kind::Hash) {
+        if (scheme.hash_partitions < 2 || scheme.hash_partitions > 1024) {
+            throw std::runtime_error("HASH partition count must be between 2 and 1024.");
+        }
+        return;
+    }
+    if (scheme.range_bounds.empty() || scheme.range_bounds.size() > 1023) {
+        throw std::runtime_error("RANGE partitioning needs between 1 and 1023 bounds.");
+    }
+    Value::Type expected = column_value_type(type);
+    for (size_t i = 0; i < scheme.range_bounds.size(); ++i) {
+        if (!scheme.range_bounds[i].has_value() || scheme.range_bounds[i].type() != expected) {
+            throw std::runtime_error("RANGE bound " + format_literal(scheme.range_bounds[i]) +
+                " does not match type " + type + " of column " + scheme.column + ".");
+        }
+        if (i > 0 && compare_values(scheme.range_bounds[i - 1], scheme.range_bounds[i]) >= 0) {
+            throw std::runtime_error("RANGE bounds must be strictly increasing.");
+        }
+    }
+}
+
+size_t partition_of(const PartitionScheme& scheme, const Value& key) {
+    if (!key.has_value()) {
+        return 0;
+    }
+    if (scheme.kind == PartitionScheme::Kind::Hash) {
+        return static_cast<size_t>(stable_hash(key) % scheme.hash_partitions);
+    }
+    return bound_position(scheme, key, true);
+}
+
+std::vector<size_t> prune_partitions(const PartitionScheme& scheme, const Condition& condition) {
+    std::vector<bool> mask = prune_mask(scheme, condition);
+    std::vector<size_t> result;
+    for (size_t i = 0; i < mask.size(); ++i) {
+        if (mask[i]) {
+            result.push_back(i);
+        }
+    }
+    return result;
+}
+
+std::string describe_partitioning(const PartitionScheme& scheme) {
+    std::ostringstream out;
+    switch (scheme.kind) {
+    case PartitionScheme::Kind::None:
+        return "none";
+    case PartitionScheme::Kind::Hash:
+        out << "HASH(" << scheme.column << ") PARTITIONS " << scheme.hash_partitions;
+        break;
+    case PartitionScheme::Kind::Range:
+        out << "RANGE(" << scheme.column << ") VALUES (";
+        for (size_t i = 0; i < scheme.range_bounds.size(); ++i) {
+            out << (i > 0 ? ", " : "") << format_literal(scheme.range_bounds[i]);
+        }
+        out << ")";
+        break;
+    }
+    return out.str();
+}
@@ -0,0 +1,37 @@
+#ifndef PARTITION_H
+#define PARTITION_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "planner.h"
+#include "value.h"
+
+//       .
+// HASH(col) PARTITIONS n -    ; RANGE(col) VALUES (b1, ..., bk) -
+// k + 1 : (-inf, b1), [b1, b2), ..., [bk, +inf). NULL     .
+struct PartitionScheme {
+    enum class Kind { None, Hash, Range };
+
+    Kind kind = Kind::None;
+    std::string column;
+    size_t hash_partitions = 0;
+    std::vector<Value> range_bounds;     //   
+};
+
+size_t partition_count(const PartitionScheme& scheme);
+
+//       .
+void validate_partitioning(const PartitionScheme& scheme, const std::map<std::string, std::string>& column_types);
+
+//     .      
+// ,       .
+size_t partition_of(const PartitionScheme& scheme, const Value& key);
+
+// ,     ,   ( ).
+std::vector<size_t> prune_partitions(const PartitionScheme& scheme, const Condition& condition);
+
+//  "RANGE(ts) VALUES (100, 200)".
+std::string describe_partitioning(const PartitionScheme& scheme);
+
+#endif // PARTITION_H
@@ -0,0 +1,792 @@
+#include "planner.h"
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include "utils.h"
+
+//       .
+static const double DEFAULT_EQ_SELECTIVITY = 0.1;
+static const double DEFAULT_RANGE_SELECTIVITY = 1.0 / 3.0;
+static const double DEFAULT_PREFIX_SELECTIVITY = 0.05;
+static const double DEFAULT_INFIX_SELECTIVITY = 0.1;
+static const size_t HISTOGRAM_BUCKETS = 16;
+static const double BITMAP_ROW_COST = 0.02;    //        
+
+//       .
+static std::vector<size_t> find_top_level(const std::string& text, const std::string& keyword) {
+    std::vector<size_t> positions;
+    int depth = 0;
+    bool in_quotes = false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        char c = text[i];
+        if (c == '\'') {
+            in_quotes = !in_quotes;
+        }
+        else if (!in_quotes && c == '(') {
+            ++depth;
+        }
+        else if (!in_quotes && c == ')') {
+            --depth;
+        }
+        else if (!in_quotes && depth == 0 && text.compare(i, keyword.size(), keyword) == 0) {
+            positions.push_back(i);
+            i += keyword.size() - 1;
+        }
+    }
+    return positions;
+}
+
+static std::vector<std::string> split_top_level(const std::string& text, const std::string& keyword) {
+    std::vector<std::string> parts;
+    size_t start = 0;
+    for (size_t pos : find_top_level(text, keyword)) {
+        parts.push_back(text.substr(start, pos - start));
+        start = pos + keyword.size();
+    }
+    parts.push_back(text.substr(start));
+    return parts;
+}
+
+// ,        .
+static bool wrapped_in_parens(const std::string& text) {
+    if (text.size() < 2 || text.front() != '(' || text.back() != ')') {
+        return false;
+    }
+    int depth = 0;
+    bool in_quotes = false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\'') {
+            in_quotes = !in_quotes;
+        }
+        else if (!in_quotes && text[i] == '(') {
+            ++depth;
+        }
+        else if (!in_quotes && text[i] == ')' && --depth == 0 && i + 1 < text.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//       .
+static Value parse_literal(const std::string& literal) {
+    if (literal.empty() || literal == "NULL" || literal == "null") {
+        return Value();
+    }
+    if (literal.size() >= 2 && literal[0] == '\'' && literal.back() == '\'') {
+        return literal.substr(1, literal.size() - 2);
+    }
+    if (literal == "true" || literal == "false") {
+        return literal == "true";
+    }
+    if (!is_numeric(literal)) {
+        throw std::runtime_error("Invalid integer format in condition: " + literal);
+    }
+    return std::stoi(literal);
+}
+
+// "col LIKE ''"  "col NOT LIKE ''".
+static bool parse_like(const std::string& condition, Condition& result) {
+    auto positions = find_top_level(condition, " LIKE ");
+    if (positions.empty()) {
+        return false;
+    }
+    std::string column = trim(condition.substr(0, positions[0]));
+    std::string literal = trim(condition.substr(positions[0] + 6));
+    bool negated = column.size() > 4 && column.compare(column.size() - 4, 4, " NOT") == 0;
+    if (negated) {
+        column = trim(column.substr(0, column.size() - 4));
+    }
+    if (column.empty()) {
+        throw std::runtime_error("Column name is empty in condition: " + condition);
+    }
+    if (literal.size() < 2 || literal.front() != '\'' || literal.back() != '\'') {
+        throw std::runtime_error("LIKE expects a quoted pattern in condition: " + condition);
+    }
+
+    Condition like;
+    like.kind = Condition::Kind::Compare;
+    like.op = CompareOp::Like;
+    like.column = column;
+    like.value = literal.substr(1, literal.size() - 2);
+    if (negated) {
+        result.kind = Condition::Kind::Not;
+        result.children.push_back(std::move(like));
+    }
+    else {
+        result = std::move(like);
+    }
+    return true;
+}
+
+static Condition parse_compare(const std::string& condition) {
+    Condition like;
+    if (parse_like(condition, like)) {
+        return like;
+    }
+
+    static const std::pair<const char*, CompareOp> operators[] = {
+        {"!=", CompareOp::Ne}, {"<>", CompareOp::Ne}, {"<=", CompareOp::Le}, {">=", CompareOp::Ge},
+        {"=", CompareOp::Eq}, {"<", CompareOp::Lt}, {">", CompareOp::Gt},
+    };
+
+    bool in_quotes = false;
+    for (size_t i = 0; i < condition.size(); ++i) {
+        if (condition[i] == '\'') {
+            in_quotes = !in_quotes;
+            continue;
+        }
+        if (in_quotes) {
+            continue;
+        }
+        for (const auto& [symbol, op] : operators) {
+            std::string text(symbol);
+            if (condition.compare(i, text.size(), text) != 0) {
+                continue;
+            }
+            Condition result;
+            result.kind = Condition::Kind::Compare;
+            result.op = op;
+            result.column = trim(condition.substr(0, i));
+            if (result.column.empty()) {
+                throw std::runtime_error("Column name is empty in condition: " + condition);
+            }
+            std::string literal = trim(condition.substr(i + text.size()));
+            try {
+                result.value = parse_literal(literal);
+            }
+            catch (const std::exception& e) {
+                throw std::runtime_error("Failed to parse value in condition: " + literal + ", error: " + e.what());
+            }
+            if (!result.value.has_value() && op != CompareOp::Eq && op != CompareOp::Ne) {
+                throw std::runtime_error("NULL can only be compared with = or != in condition: " + condition);
+            }
+            return result;
+        }
+    }
+    throw std::runtime_error("Syntax error in condition: " + condition);
+}
+
+Condition parse_condition_tree(const std::string& condition) {
+    std::string text = trim(condition);
+    if (text.empty()) {
+        throw std::runtime_error("Empty condition.");
+    }
+
+    auto disjuncts = split_top_level(text, " OR ");
+    if (disjuncts.size() > 1) {
+        Condition result;
+        result.kind = Condition::Kind::Or;
+        for (const auto& part : disjuncts) {
+            result.children.push_back(parse_condition_tree(part));
+        }
+        return result;
+    }
+
+    auto conjuncts = split_top_level(text, " AND ");
+    if (conjuncts.size() > 1) {
+        Condition result;
+        result.kind = Condition::Kind::And;
+        for (const auto& part : conjuncts) {
+            result.children.push_back(parse_condition_tree(part));
+        }
+        return result;
+    }
+
+    if (text.compare(0, 4, "NOT ") == 0) {
+        Condition result;
+        result.kind = Condition::Kind::Not;
+        result.children.push_back(parse_condition_tree(text.substr(4)));
+        return result;
+    }
+
+    if (wrapped_in_parens(text)) {
+        return parse_condition_tree(text.substr(1, text.size() - 2));
+    }
+
+    //  "true"  "false" ,    /
+    if (text == "true" || text == "false") {
+        Condition result;
+        result.constant = (text == "true");
+        return result;
+    }
+
+    return parse_compare(text);
+}
+
+const char* compare_op_name(CompareOp op) {
+    switch (op) {
+    case CompareOp::Eq: return "=";
+    case CompareOp::Ne: return "!=";
+    case CompareOp::Lt: return "<";
+    case CompareOp::Le: return "<=";
+    case CompareOp::Gt: return ">";
+    case CompareOp::Ge: return ">=";
+    case CompareOp::Like: return " LIKE ";
+    }
+    return "?";
+}
+
+std::string format_literal(const Value& value) {
+    switch (value.type()) {
+    case Value::Type::Null: return "NULL";
+    case Value::Type::Int: return std::to_string(value.as_int());
+    case Value::Type::Int64: return std::to_string(value.as_int64());
+    case Value::Type::Double: return std::to_string(value.as_double());
+    case Value::Type::Bool: return value.as_bool() ? "true" : "false";
+    case Value::Type::String: return "'" + std::string(value.as_string()) + "'";
+    }
+    return "?";
+}
+
+std::string condition_to_string(const Condition& condition) {
+    switch (condition.kind) {
+    case Condition::Kind::Constant:
+        return condition.constant ? "true" : "false";
+    case Condition::Kind::Compare:
+        return condition.column + compare_op_name(condition.op) + format_literal(condition.value);
+    case Condition::Kind::Not:
+        return "NOT (" + condition_to_string(condition.children[0]) + ")";
+    case Condition::Kind::And:
+    case Condition::Kind::Or: {
+        std::string separator = condition.kind == Condition::Kind::And ? " AND " : " OR ";
+        std::string result;
+        for (size_t i = 0; i < condition.children.size(); ++i) {
+            const Condition& child = condition.children[i];
+            bool nested = child.kind == Condition::Kind::And || child.kind == Condition::Kind::Or;
+            if (i > 0) {
+                result += separator;
+            }
+            result += nested ? "(" + condition_to_string(child) + ")" : condition_to_string(child);
+        }
+        return result;
+    }
+    }
+    return "";
+}
+
+bool values_comparable(const Value& left, const Value& right) {
+    return left.has_value() && right.has_value() && left.same_type(right);
+}
+
+int compare_values(const Value& left, const Value& right) {
+    auto three_way = [](auto a, auto b) { return a < b ? -1 : (a > b ? 1 : 0); };
+    switch (left.type()) {
+    case Value::Type::Int: return three_way(left.as_int(), right.as_int());
+    case Value::Type::Int64: return three_way(left.as_int64(), right.as_int64());
+    case Value::Type::Double: return three_way(left.as_double(), right.as_double());
+    case Value::Type::Bool: return three_way(left.as_bool(), right.as_bool());
+    case Value::Type::String: return three_way(left.as_string().compare(right.as_string()), 0);
+    case Value::Type::Null: break;
+    }
+    throw std::runtime_error("Unsupported type for comparison.");
+}
+
+int compare_cells(const Value& left, const Value& right) {
+    if (!left.has_value() || !right.has_value()) {
+        return static_cast<int>(left.has_value()) - static_cast<int>(right.has_value());
+    }
+    return compare_values(left, right);
+}
+
+bool RowLess::operator()(const std::vector<Value>& left, const std::vector<Value>& right) const {
+    size_t count = std::min(left.size(), right.size());
+    for (size_t i = 0; i < count; ++i) {
+        int result = compare_cells(left[i], right[i]);
+        if (result != 0) {
+            return result < 0;
+        }
+    }
+    return left.size() < right.size();
+}
+
+bool compare_matches(CompareOp op, int comparison) {
+    switch (op) {
+    case CompareOp::Eq: return comparison == 0;
+    case CompareOp::Ne: return comparison != 0;
+    case CompareOp::Lt: return comparison < 0;
+    case CompareOp::Le: return comparison <= 0;
+    case CompareOp::Gt: return comparison > 0;
+    case CompareOp::Ge: return comparison >= 0;
+    case CompareOp::Like: return false;
+    }
+    return false;
+}
+
+bool like_matches(std::string_view pattern, std::string_view text) {
+    //       '%'
+    size_t p = 0, t = 0;
+    size_t star = std::string_view::npos, star_text = 0;
+    while (t < text.size()) {
+        if (p < pattern.size() && (pattern[p] == '_' || (pattern[p] != '%' && pattern[p] == text[t]))) {
+            ++p;
+            ++t;
+        }
+        else if (p < pattern.size() && pattern[p] == '%') {
+            star = p++;
+            star_text = t;
+        }
+        else if (star != std::string_view::npos) {
+            p = star + 1;
+            t = ++star_text;
+        }
+        else {
+            return false;
+        }
+    }
+    while (p < pattern.size() && pattern[p] == '%') {
+        ++p;
+    }
+    return p == pattern.size();
+}
+
+bool like_has_wildcards(std::string_view pattern) {
+    return pattern.find_first_of("%_") != std::string_view::npos;
+}
+
+std::string like_prefix(std::string_view pattern) {
+    return std::string(pattern.substr(0, std::min(pattern.find_first_of("%_"), pattern.size())));
+}
+
+std::vector<std::string> like_fragments(std::string_view pattern) {
+    std::vector<std::string> fragments;
+    std::string current;
+    for (char c : pattern) {
+        if (c == '%' || c == '_') {
+            if (!current.empty()) {
+                fragments.push_back(current);
+                current.clear();
+            }
+        }
+        else {
+            current += c;
+        }
+    }
+    if (!current.empty()) {
+        fragments.push_back(current);
+    }
+    return fragments;
+}
+
+ColumnStats compute_column_stats(std::vector<Value> values) {
+    ColumnStats stats;
+    stats.row_count = values.size();
+
+    auto first_null = std::partition(values.begin(), values.end(), [](const Value& v) { return v.has_value(); });
+    stats.null_count = std::distance(first_null, values.end());
+    values.erase(first_null, values.end());
+    if (values.empty()) {
+        return stats;
+    }
+
+    std::sort(values.begin(), values.end(), [](const Value& a, const Value& b) {
+        return compare_values(a, b) < 0;
+        });
+    stats.min_value = values.front();
+    stats.max_value = values.back();
+    stats.distinct_count = 1;
+    for (size_t i = 1; i < values.size(); ++i) {
+        if (compare_values(values[i - 1], values[i]) != 0) {
+            ++stats.distinct_count;
+        }
+    }
+
+    if (values.front().is_bool()) {
+        stats.true_count = std::count_if(values.begin(), values.end(), [](const Value& v) {
+            return v.as_bool();
+            });
+    }
+    else if (values.front().is_int()) {
+        size_t buckets = std::min(HISTOGRAM_BUCKETS, values.size());
+        for (size_t i = 0; i <= buckets; ++i) {
+            stats.histogram.push_back(values[i * (values.size() - 1) / buckets].as_int());
+        }
+    }
+    return stats;
+}
+
+//   ,  value.
+static double histogram_fraction_below(const std::vector<int>& bounds, int value) {
+    if (value <= bounds.front()) {
+        return 0.0;
+    }
+    if (value > bounds.back()) {
+        return 1.0;
+    }
+    size_t buckets = bounds.size() - 1;
+    for (size_t i = 0; i < buckets; ++i) {
+        if (value <= bounds[i + 1]) {
+            double width = static_cast<double>(bounds[i + 1]) - bounds[i];
+            double inside = width > 0 ? (static_cast<double>(value) - bounds[i]) / width : 0.0;
+            return (i + inside) / buckets;
+        }
+    }
+    return 1.0;
+}
+
+static double compare_selectivity(const Condition& condition, const TableStats& stats) {
+    auto it = stats.columns.find(condition.column);
+    bool has_stats = stats.analyzed && it != stats.columns.end() && it->second.row_count > 0;
+    bool equality = condition.op == CompareOp::Eq || condition.op == CompareOp::Ne;
+
+    if (!has_stats) {
+        if (condition.op == CompareOp::Like) {
+            std::string_view pattern = condition.value.as_string();
+            return !like_has_wildcards(pattern) ? DEFAULT_EQ_SELECTIVITY
+                : like_prefix(pattern).empty() ? DEFAULT_INFIX_SELECTIVITY : DEFAULT_PREFIX_SELECTIVITY;
+        }
+        double eq = equality ? DEFAULT_EQ_SELECTIVITY : DEFAULT_RANGE_SELECTIVITY;
+        return condition.op == CompareOp::Ne ? 1.0 - eq : eq;
+    }
+
+    const ColumnStats& column = it->second;
+    double rows = static_cast<double>(column.row_count);
+    double null_fraction = column.null_count / rows;
+    double non_null = 1.0 - null_fraction;
+
+    if (condition.op == CompareOp::Like) {
+        std::string_view pattern = condition.value.as_string();
+        if (!like_has_wildcards(pattern)) {
+            return non_null / std::max<size_t>(column.distinct_count, 1);
+        }
+        return non_null * (like_prefix(pattern).empty() ? DEFAULT_INFIX_SELECTIVITY : DEFAULT_PREFIX_SELECTIVITY);
+    }
+
+    if (!condition.value.has_value()) {
+        return condition.op == CompareOp::Eq ? null_fraction : non_null;
+    }
+    if (!values_comparable(condition.value, column.min_value)) {
+        return 0.0;
+    }
+
+    int vs_min = compare_values(condition.value, column.min_value);
+    int vs_max = compare_values(condition.value, column.max_value);
+
+    if (equality) {
+        double eq;
+        if (vs_min < 0 || vs_max > 0) {
+            eq = 0.0;
+        }
+        else if (condition.value.is_bool()) {
+            eq = (condition.value.as_bool() ? column.true_count
+                : column.row_count - column.null_count - column.true_count) / rows;
+        }
+        else {
+            eq = non_null / std::max<size_t>(column.distinct_count, 1);
+        }
+        return condition.op == CompareOp::Eq ? eq : non_null - eq;
+    }
+
+    double below;
+    if (!column.histogram.empty()) {
+        below = histogram_fraction_below(column.histogram, condition.value.as_int());
+    }
+    else if (vs_min <= 0) {
+        below = 0.0;
+    }
+    else if (vs_max > 0) {
+        below = 1.0;
+    }
+    else {
+        below = DEFAULT_RANGE_SELECTIVITY;
+    }
+
+    double fraction = (condition.op == CompareOp::Lt || condition.op == CompareOp::Le) ? below : 1.0 - below;
+    return std::clamp(fraction, 0.0, 1.0) * non_null;
+}
+
+double estimate_selectivity(const Condition& condition, const TableStats& stats) {
+    switch (condition.kind) {
+    case Condition::Kind::Constant:
+        return condition.constant ? 1.0 : 0.0;
+    case Condition::Kind::Compare:
+        return compare_selectivity(condition, stats);
+    case Condition::Kind::Not:
+        return 1.0 - estimate_selectivity(condition.children[0], stats);
+    case Condition::Kind::And: {
+        double result = 1.0;
+        for (const auto& child : condition.children) {
+            result *= estimate_selectivity(child, stats);
+        }
+        return result;
+    }
+    case Condition::Kind::Or: {
+        double none = 1.0;
+        for (const auto& child : condition.children) {
+            none *= 1.0 - estimate_selectivity(child, stats);
+        }
+        return 1.0 - none;
+    }
+    }
+    return 1.0;
+}
+
+//           .
+double estimate_cost(const Condition& condition, const TableStats& stats) {
+    switch (condition.kind) {
+    case Condition::Kind::Constant:
+        return 0.0;
+    case Condition::Kind::Compare:
+        if (condition.op == CompareOp::Like) {
+            return 4.0;
+        }
+        return condition.value.is_string() ? 2.0 : 1.0;
+    case Condition::Kind::Not:
+        return estimate_cost(condition.children[0], stats);
+    case Condition::Kind::And:
+    case Condition::Kind::Or: {
+        bool is_and = condition.kind == Condition::Kind::And;
+        double reach = 1.0, cost = 0.0;
+        for (const auto& child : condition.children) {
+            cost += reach * estimate_cost(child, stats);
+            double selectivity = estimate_selectivity(child, stats);
+            reach *= is_and ? selectivity : 1.0 - selectivity;
+        }
+        return cost;
+    }
+    }
+    return 0.0;
+}
+
+void order_predicates(Condition& condition, const TableStats& stats) {
+    for (auto& child : condition.children) {
+        order_predicates(child, stats);
+    }
+    if (condition.kind != Condition::Kind::And && condition.kind != Condition::Kind::Or) {
+        return;
+    }
+
+    //  : ( ,     - 1) / .
+    //  AND  -  ,  OR - ;    .
+    bool is_and = condition.kind == Condition::Kind::And;
+    auto rank = [&](const Condition& child) {
+        double selectivity = estimate_selectivity(child, stats);
+        double pass = is_and ? selectivity : 1.0 - selectivity;
+        return (pass - 1.0) / std::max(estimate_cost(child, stats), 0.01);
+        };
+    std::vector<std::pair<double, Condition>> ranked;
+    for (auto& child : condition.children) {
+        ranked.emplace_back(rank(child), std::move(child));
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    condition.children.clear();
+    for (auto& [child_rank, child] : ranked) {
+        condition.children.push_back(std::move(child));
+    }
+}
+
+static bool value_matches_type(const Value& value, const std::string& type) {
+    return (type == "int32" && value.is_int()) ||
+        (type == "string" && value.is_string());
+}
+
+//    ,           .
+static bool like_searchable(std::string_view pattern) {
+    if (!like_prefix(pattern).empty()) {
+        return true;
+    }
+    for (const auto& fragment : like_fragments(pattern)) {
+        if (fragment.size() >= 3) {
+            return true;
+        }
+    }
+    return false;
+}
+
+BitmapCoverage bitmap_coverage(const Condition& condition, const std::set<std::string>& bitmap_columns) {
+    BitmapCoverage result;
+    switch (condition.kind) {
+    case Condition::Kind::Constant:
+        result.known = result.exact = true;
+        break;
+    case Condition::Kind::Compare:
+        result.known = result.exact = bitmap_columns.count(condition.column) > 0;
+        break;
+    case Condition::Kind::Not:
+        //     
+        result.known = result.exact = bitmap_coverage(condition.children[0], bitmap_columns).exact;
+        break;
+    case Condition::Kind::And:
+        result.exact = true;
+        for (const auto& child : condition.children) {
+            BitmapCoverage part = bitmap_coverage(child, bitmap_columns);
+            result.known = result.known || part.known;
+            result.exact = result.exact && part.exact;
+        }
+        break;
+    case Condition::Kind::Or:
+        result.known = result.exact = true;
+        for (const auto& child : condition.children) {
+            BitmapCoverage part = bitmap_coverage(child, bitmap_columns);
+            result.known = result.known && part.known;
+            result.exact = result.exact && part.exact;
+        }
+        break;
+    }
+    return result;
+}
+
+//  -   :   AND -   .
+static double bitmap_fraction(const Condition& condition, const TableStats& stats, const std::set<std::string>& bitmap_columns) {
+    if (condition.kind != Condition::Kind::And || bitmap_coverage(condition, bitmap_columns).exact) {
+        return estimate_selectivity(condition, stats);
+    }
+    double fraction = 1.0;
+    for (const auto& child : condition.children) {
+        if (bitmap_coverage(child, bitmap_columns).known) {
+            fraction *= bitmap_fraction(child, stats, bitmap_columns);
+        }
+    }
+    return fraction;
+}
+
+static size_t leaf_count(const Condition& condition) {
+    size_t count = condition.kind == Condition::Kind::Compare ? 1 : 0;
+    for (const auto& child : condition.children) {
+        count += leaf_count(child);
+    }
+    return count;
+}
+
+QueryPlan make_plan(Condition condition, const TableStats& stats,
+    const std::map<std::string, std::string>& column_types,
+    const std::set<std::string>& indexed_columns,
+    const std::set<std::string>& text_indexed_columns,
+    const std::map<std::string, std::vector<std::string>>& composite_indexes,
+    const std::set<std::string>& bitmap_columns) {
+    order_predicates(condition, stats);
+
+    QueryPlan plan;
+    double rows = static_cast<double>(stats.row_count);
+    double per_row = estimate_cost(condition, stats);
+    plan.scan_cost = rows * per_row;
+    plan.estimated_cost = plan.scan_cost;
+    plan.estimated_rows = rows * estimate_selectivity(condition, stats);
+
+    //     :       
+    std::vector<const Condition*> probes;
+    if (condition.kind == Condition::Kind::Compare) {
+        probes.push_back(&condition);
+    }
+    else if (condition.kind == Condition::Kind::And) {
+        for (const auto& child : condition.children) {
+            probes.push_back(&child);
+        }
+    }
+
+    for (const Condition* probe : probes) {
+        if (probe->kind != Condition::Kind::Compare || indexed_columns.find(probe->column) == indexed_columns.end()) {
+            continue;
+        }
+        bool like_probe = probe->op == CompareOp::Like &&
+            text_indexed_columns.find(probe->column) != text_indexed_columns.end() &&
+            like_searchable(probe->value.as_string());
+        if (probe->op != CompareOp::Eq && !like_probe) {
+            continue;
+        }
+        auto type_it = column_types.find(probe->column);
+        if (type_it == column_types.end() || !value_matches_type(probe->value, type_it->second)) {
+            continue;
+        }
+        double matches = rows * estimate_selectivity(*probe, stats);
+        double cost = 1.0 + matches * (1.0 + per_row);
+        if (cost < plan.estimated_cost) {
+            plan.use_index = true;
+            plan.index_column = probe->column;
+            plan.index_op = probe->op;
+            plan.index_key = probe->value;
+            plan.estimated_cost = cost;
+        }
+    }
+
+    //  :     ,    
+    // (      bool)
+    for (const auto& [name, key_columns] : composite_indexes) {
+        std::vector<const Condition*> prefix;
+        for (const auto& column : key_columns) {
+            auto type_it = column_types.find(column);
+            auto equality = std::find_if(probes.begin(), probes.end(), [&](const Condition* probe) {
+                return probe->kind == Condition::Kind::Compare && probe->op == CompareOp::Eq && probe->column == column &&
+                    type_it != column_types.end() && probe->value.has_value() &&
+                    probe->value.type() == column_value_type(type_it->second);
+                });
+            if (equality == probes.end()) {
+                break;
+            }
+            prefix.push_back(*equality);
+        }
+        if (prefix.empty()) {
+            continue;
+        }
+        double matches = rows;
+        for (const Condition* probe : prefix) {
+            matches *= estimate_selectivity(*probe, stats);
+        }
+        double cost = 1.0 + matches * (1.0 + per_row);
+        if (cost < plan.estimated_cost) {
+            plan.use_index = true;
+            plan.index_column = name;
+            plan.index_op = CompareOp::Eq;
+            plan.index_key = Value();
+            plan.index_columns.clear();
+            plan.index_prefix.clear();
+            for (const Condition* probe : prefix) {
+                plan.index_columns.push_back(probe->column);
+                plan.index_prefix.push_back(probe->value);
+            }
+            plan.estimated_cost = cost;
+        }
+    }
+
+    //  :          
+    //   ,      
+    BitmapCoverage coverage = bitmap_coverage(condition, bitmap_columns);
+    if (coverage.known && !bitmap_columns.empty()) {
+        double candidates = rows * bitmap_fraction(condition, stats, bitmap_columns);
+        double cost = BITMAP_ROW_COST * rows * static_cast<double>(std::max<size_t>(1, leaf_count(condition))) +
+            candidates * (coverage.exact ? BITMAP_ROW_COST : 1.0 + per_row);
+        if (cost < plan.estimated_cost) {
+            plan.use_index = false;
+            plan.index_columns.clear();
+            plan.index_prefix.clear();
+            plan.use_bitmap = true;
+            plan.bitmap_exact = coverage.exact;
+            plan.estimated_cost = cost;
+        }
+    }
+
+    plan.condition = std::move(condition);
+    return plan;
+}
+
+std::string describe_access(const QueryPlan& plan) {
+    if (!plan.use_index) {
+        return condition_to_string(plan.condition);
+    }
+    if (!plan.index_columns.empty()) {
+        std::string access;
+        for (size_t i = 0; i < plan.index_columns.size(); ++i) {
+            access += (i > 0 ? " AND " : "") + plan.index_columns[i] + "=" + format_literal(plan.index_prefix[i]);
+        }
+        return access;
+    }
+    return plan.index_column + compare_op_name(plan.index_op) + format_literal(plan.index_key);
+}
+
+std::string describe_plan(const QueryPlan& plan, size_t table_rows) {
+    std::ostringstream out;
+    if (plan.use_index) {
+        out << "access: index probe on " << plan.index_column << " (" << describe_access(plan) << ")\n";
+    }
+    else if (plan.use_bitmap) {
+        out << "access: bitmap index" << (plan.bitmap_exact ? "" : " with row check") << "\n";
+    }
+    else {
+        out << "access: full scan\n";
+    }
+    out << "predicates: " << condition_to_string(plan.condition) << "\n";
+    out << "estimated rows: " << static_cast<size_t>(plan.estimated_rows + 0.5) << " of " << table_rows << "\n";
+    out << "estimated cost: " << plan.estimated_cost << " (full scan: " << plan.scan_cost << ")\n";
+    return out.str();
+}
@@ -0,0 +1,119 @@
+#ifndef PLANNER_H
+#define PLANNER_H
+
+#include <map>
+#include <set>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "value.h"
+
+//      WHERE.
+// Like -     ('%' -  , '_' -  ).
+enum class CompareOp { Eq, Ne, Lt, Le, Gt, Ge, Like };
+
+//   WHERE   .
+struct Condition {
+    enum class Kind { Constant, Compare, And, Or, Not };
+
+    Kind kind = Kind::Constant;
+    bool constant = true;           //   Kind::Constant
+    std::string column;             //   Kind::Compare
+    CompareOp op = CompareOp::Eq;
+    Value value;                 //    NULL
+    std::vector<Condition> children;
+};
+
+//   ,   ANALYZE.
+struct ColumnStats {
+    size_t row_count = 0;
+    size_t null_count = 0;
+    size_t distinct_count = 0;
+    size_t true_count = 0;          //   bool
+    Value min_value;
+    Value max_value;
+    std::vector<int> histogram;     //     int32
+};
+
+struct TableStats {
+    bool analyzed = false;
+    size_t row_count = 0;
+    std::map<std::string, ColumnStats> columns;
+};
+
+//    .
+struct QueryPlan {
+    Condition condition;            //    
+    bool use_index = false;
+    std::string index_column;
+    CompareOp index_op = CompareOp::Eq;  // Eq -  , Like -     index_key
+    Value index_key;
+    //   (index_column -  ):     
+    std::vector<std::string> index_columns;
+    std::vector<Value> index_prefix;
+    //     (AND/OR/NOT  );  bitmap_exact,
+    //        
+    bool use_bitmap = false;
+    bool bitmap_exact = false;
+    double estimated_rows = 0.0;
+    double estimated_cost = 0.0;
+    double scan_cost = 0.0;
+};
+
+//   WHERE. OR   AND, AND  NOT;  .
+Condition parse_condition_tree(const std::string& condition);
+std::string condition_to_string(const Condition& condition);
+const char* compare_op_name(CompareOp op);
+std::string format_literal(const Value& value);
+
+//       (-1, 0, 1).
+bool values_comparable(const Value& left, const Value& right);
+int compare_values(const Value& left, const Value& right);
+bool compare_matches(CompareOp op, int comparison);
+
+//       NULL: NULL   .
+int compare_cells(const Value& left, const Value& right);
+//     compare_cells (    ).
+struct RowLess {
+    bool operator()(const std::vector<Value>& left, const std::vector<Value>& right) const;
+};
+
+//  LIKE.
+bool like_matches(std::string_view pattern, std::string_view text);
+bool like_has_wildcards(std::string_view pattern);
+std::string like_prefix(std::string_view pattern);                  //     
+std::vector<std::string> like_fragments(std::string_view pattern);  //     
+
+ColumnStats compute_column_stats(std::vector<Value> values);
+
+double estimate_selectivity(const Condition& condition, const TableStats& stats);
+double estimate_cost(const Condition& condition, const TableStats& stats);
+
+//   ( ) ,       .
+void order_predicates(Condition& condition, const TableStats& stats);
+
+//    :         .
+std::string describe_access(const QueryPlan& plan);
+
+//    EXPLAIN:  ,  ,    .
+std::string describe_plan(const QueryPlan& plan, size_t table_rows);
+
+// text_indexed_columns -    ,     LIKE;
+// composite_indexes -       ;
+// bitmap_columns -    .
+QueryPlan make_plan(Condition condition, const TableStats& stats,
+    const std::map<std::string, std::string>& column_types,
+    const std::set<std::string>& indexed_columns,
+    const std::set<std::string>& text_indexed_columns = {},
+    const std::map<std::string, std::vector<std::string>>& composite_indexes = {},
+    const std::set<std::string>& bitmap_columns = {});
+
+//     : known -    (
+//  ), exact -    .
+struct BitmapCoverage {
+    bool known = false;
+    bool exact = false;
+};
+BitmapCoverage bitmap_coverage(const Condition& condition, const std::set<std::string>& bitmap_columns);
+
+#endif // PLANNER_H
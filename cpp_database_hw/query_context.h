@@ -0,0 +1,112 @@
+#ifndef QUERY_CONTEXT_H
+#define QUERY_CONTEXT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+//   :  ,    .
+struct QueryContext {
+    std::atomic<bool> cancelled{ false };
+    std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+    // ,      ( , ,
+    //  );    QueryMemoryCharge.
+    mutable std::atomic<size_t> memory_bytes{ 0 };
+    //   memory_bytes (EXPLAIN ANALYZE     ).
+    mutable std::atomic<size_t> memory_peak{ 0 };
+    size_t memory_limit = 0;    // 0 -  
+
+    size_t memory_in_use() const {
+        return memory_bytes.load(std::memory_order_relaxed);
+    }
+
+    void raise_memory_peak(size_t bytes) const {
+        size_t peak = memory_peak.load(std::memory_order_relaxed);
+        while (bytes > peak && !memory_peak.compare_exchange_weak(peak, bytes, std::memory_order_relaxed)) {
+        }
+    }
+
+    //  ,   ,     .
+    void check() const {
+        if (cancelled) {
+            throw std::runtime_error("Query cancelled.");
+        }
+        if (std::chrono::steady_clock::now() > deadline) {
+            throw std::runtime_error("Query timed out.");
+        }
+        check_memory();
+    }
+
+    //  ,     .
+    void check_memory() const {
+        if (memory_limit && memory_in_use() > memory_limit) {
+            throw std::runtime_error("Query memory limit exceeded: " + std::to_string(memory_in_use()) +
+                " bytes in use, limit " + std::to_string(memory_limit) + ".");
+        }
+    }
+};
+
+//  ,     (nullptr  Database::execute).
+inline thread_local const QueryContext* current_query_context = nullptr;
+
+//  ,        ( ).
+inline void check_query_interrupted() {
+    if (current_query_context) {
+        current_query_context->check();
+    }
+}
+
+// ,     ,   . 
+//    ,        .
+class QueryMemoryCharge {
+public:
+    QueryMemoryCharge() : context(current_query_context) {}
+    ~QueryMemoryCharge() {
+        if (context) {
+            context->memory_bytes.fetch_sub(charged, std::memory_order_relaxed);
+        }
+    }
+    QueryMemoryCharge(const QueryMemoryCharge&) = delete;
+    QueryMemoryCharge& operator=(const QueryMemoryCharge&) = delete;
+
+    //     bytes     .  
+    //    ,  check_query_interrupted.
+    void set(size_t bytes) {
+        if (!context) {
+            return;
+        }
+        if (bytes >= charged) {
+            size_t in_use = context->memory_bytes.fetch_add(bytes - charged, std::memory_order_relaxed) + (bytes - charged);
+            context->raise_memory_peak(in_use);
+        }
+        else {
+            context->memory_bytes.fetch_sub(charged - bytes, std::memory_order_relaxed);
+        }
+        charged = bytes;
+        context->check_memory();
+    }
+
+private:
+    const QueryContext* context;
+    size_t charged = 0;
+};
+
+//          .
+class ScopedQueryContext {
+public:
+    explicit ScopedQueryContext(const QueryContext* context) : previous(current_query_context) {
+        current_query_context = context;
+    }
+    ~ScopedQueryContext() {
+        current_query_context = previous;
+    }
+    ScopedQueryContext(const ScopedQueryContext&) = delete;
+    ScopedQueryContext& operator=(const ScopedQueryContext&) = delete;
+
+private:
+    const QueryContext* previous;
+};
+
+#endif // QUERY_CONTEXT_H
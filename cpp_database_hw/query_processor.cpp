@@ -1,11 +1,332 @@
 #include "query_processor.h"
 #include "database.h"
+#include "csv.h"
+#include "query_profile.h"
 #include <sstream>
 #include <stdexcept>
 #include <iostream> 
 #include <algorithm>
+#include <cctype>
+#include <limits>
+#include <unordered_set>
 #include "utils.h"
+#include "workload.h"
 
+static size_t parse_count(const std::string& text, const std::string& clause) {
+    if (!is_numeric(text) || text[0] == '-') {
+        throw std::runtime_error("Syntax error: Expected a non-negative number after " + clause + ".");
+    }
+    return std::stoull(text);
+}
+
+//   INSERT, UPDATE, DELETE  COPY FROM:  
+//        .
+static Table* modifiable_table(Database& db, const std::string& table_name) {
+    Table* table = db.get_table_for_write(table_name);
+    if (!table) throw std::runtime_error("Table not found: " + table_name);
+    if (table->is_view()) throw std::runtime_error("Cannot modify materialized view " + table_name + ".");
+    return table;
+}
+
+// PARTITION BY HASH(col) PARTITIONS n | PARTITION BY RANGE(col) VALUES (b1, b2, ...)
+static PartitionScheme parse_partitioning(const std::string& text) {
+    std::istringstream stream(text);
+    std::string partition_kw, by_kw, method, column, keyword;
+    stream >> partition_kw >> by_kw;
+    if (partition_kw != "PARTITION" || by_kw != "BY") {
+        throw std::runtime_error("Syntax error: Expected 'PARTITION BY' after table schema.");
+    }
+    std::getline(stream, method, '(');
+    std::getline(stream, column, ')');
+    method = trim(method);
+    column = trim(column);
+    if (column.empty()) {
+        throw std::runtime_error("Syntax error: Expected partition column in parentheses.");
+    }
+
+    PartitionScheme scheme;
+    scheme.column = column;
+    stream >> keyword;
+    if (method == "HASH") {
+        std::string count;
+        stream >> count;
+        if (keyword != "PARTITIONS") {
+            throw std::runtime_error("Syntax error: Expected 'PARTITIONS <n>' after HASH(column).");
+        }
+        scheme.kind = PartitionScheme::Kind::Hash;
+        scheme.hash_partitions = parse_count(count, "PARTITIONS");
+    }
+    else if (method == "RANGE") {
+        std::string bounds;
+        std::getline(stream, bounds, '(');
+        std::getline(stream, bounds, ')');
+        if (keyword != "VALUES") {
+            throw std::runtime_error("Syntax error: Expected 'VALUES (<bounds>)' after RANGE(column).");
+        }
+        scheme.kind = PartitionScheme::Kind::Range;
+        std::istringstream bounds_stream(bounds);
+        std::string bound;
+        while (std::getline(bounds_stream, bound, ',')) {
+            bound = trim(bound);
+            if (bound.size() >= 2 && bound.front() == '\'' && bound.back() == '\'') {
+                scheme.range_bounds.push_back(bound.substr(1, bound.size() - 2));
+            }
+            else if (is_numeric(bound)) {
+                scheme.range_bounds.push_back(std::stoi(bound));
+            }
+            else {
+                throw std::runtime_error("Invalid RANGE bound: " + bound);
+            }
+        }
+    }
+    else {
+        throw std::runtime_error("Syntax error: Expected HASH or RANGE after PARTITION BY.");
+    }
+
+    std::string extra;
+    if (stream >> extra) {
+        throw std::runtime_error("Syntax error: Unexpected '" + extra + "' after PARTITION BY clause.");
+    }
+    return scheme;
+}
+
+//  SELECT.
+struct SelectStatement {
+    std::string table_name;
+    std::vector<std::string> projection;
+    std::string condition;
+    SelectOrder order;
+};
+
+static SelectStatement parse_select(const std::string& query) {
+    std::istringstream stream(query);
+    std::string command, columns, temp, table_name, rest;
+    stream >> command >> columns >> temp >> table_name;
+    if (command != "SELECT" || temp != "FROM" || table_name.empty()) {
+        throw std::runtime_error("Syntax error: Expected 'SELECT <columns> FROM <table>'.");
+    }
+    std::getline(stream, rest);
+    rest = trim(rest);
+
+    //      WHERE, ORDER BY, LIMIT [OFFSET]
+    size_t order_pos = find_keyword(rest, "ORDER");
+    size_t limit_pos = find_keyword(rest, "LIMIT", order_pos == std::string::npos ? 0 : order_pos);
+    size_t where_end = std::min(order_pos, limit_pos);
+    std::string where_part = trim(rest.substr(0, where_end));
+
+    SelectStatement statement;
+    statement.table_name = table_name;
+    std::string& condition = statement.condition;
+    condition = "true"; //  WHERE ,   
+    if (!where_part.empty()) {
+        if (where_part.compare(0, 5, "WHERE") != 0 || find_keyword(where_part, "WHERE") != 0) {
+            throw std::runtime_error("Syntax error: Unexpected '" + where_part + "' in SELECT query.");
+        }
+        condition = trim(where_part.substr(5)); //   
+        if (condition.empty()) {
+            throw std::runtime_error("Missing or empty condition in SELECT query.");
+        }
+    }
+
+    SelectOrder& order = statement.order;
+    if (order_pos != std::string::npos) {
+        std::istringstream order_stream(rest.substr(order_pos, limit_pos - order_pos));
+        order_stream >> temp >> temp; // ORDER BY
+        if (temp != "BY") throw std::runtime_error("Syntax error: Expected 'BY' after ORDER.");
+        std::string keys_def;
+        std::getline(order_stream, keys_def);
+        std::istringstream keys_stream(keys_def);
+        std::string key_def;
+        while (std::getline(keys_stream, key_def, ',')) {
+            std::istringstream key_stream(key_def);
+            OrderKey key;
+            std::string direction;
+            key_stream >> key.column >> direction;
+            if (key.column.empty()) {
+                throw std::runtime_error("Empty column name in ORDER BY.");
+            }
+            if (direction == "DESC") {
+                key.descending = true;
+            }
+            else if (!direction.empty() && direction != "ASC") {
+                throw std::runtime_error("Syntax error: Expected ASC or DESC in ORDER BY, got '" + direction + "'.");
+            }
+            order.keys.push_back(key);
+        }
+        if (order.keys.empty()) {
+            throw std::runtime_error("Missing columns in ORDER BY.");
+        }
+    }
+    if (limit_pos != std::string::npos) {
+        std::istringstream limit_stream(rest.substr(limit_pos));
+        std::string limit, offset, extra;
+        limit_stream >> temp >> limit;
+        order.limit = parse_count(limit, "LIMIT");
+        if (limit_stream >> temp) {
+            if (temp != "OFFSET" || !(limit_stream >> offset)) {
+                throw std::runtime_error("Syntax error: Expected 'OFFSET <n>' after LIMIT.");
+            }
+            order.offset = parse_count(offset, "OFFSET");
+        }
+        if (limit_stream >> extra) {
+            throw std::runtime_error("Syntax error: Unexpected '" + extra + "' after LIMIT.");
+        }
+    }
+
+    //    ; "*" -  
+    if (columns != "*") {
+        std::istringstream columns_stream(columns);
+        std::string column;
+        while (std::getline(columns_stream, column, ',')) {
+            column = trim(column);
+            if (column.empty()) {
+                throw std::runtime_error("Empty column name in SELECT query.");
+            }
+            statement.projection.push_back(column);
+        }
+    }
+
+    return statement;
+}
+
+//  INSERT TO <> (<>=<>, ...).
+struct InsertStatement {
+    std::string table_name;
+    std::map<std::string, Value> values;
+};
+
+static InsertStatement parse_insert(const std::string& query) {
+    InsertStatement statement;
+    std::istringstream stream(query);
+    std::string command, temp, values_def;
+    stream >> command >> temp; // TO
+    if (temp != "TO") throw std::runtime_error("Syntax error: Expected 'TO' after INSERT.");
+
+    stream >> statement.table_name;
+
+    std::getline(stream, values_def, '(');
+    std::getline(stream, values_def, ')');
+    values_def = trim(values_def);
+
+    if (values_def.empty()) {
+        throw std::runtime_error("No values specified for INSERT.");
+    }
+
+    std::istringstream values_stream(values_def);
+    std::string value;
+    while (std::getline(values_stream, value, ',')) {
+        auto equals_pos = value.find('=');
+        if (equals_pos != std::string::npos) {
+            std::string col_name = trim(value.substr(0, equals_pos));
+            std::string col_value = trim(value.substr(equals_pos + 1));
+
+            if (col_value.empty()) {
+                throw std::runtime_error("Empty value for column: " + col_name);
+            }
+
+            if (col_value[0] == '\'') {
+                col_value = col_value.substr(1, col_value.size() - 2);
+                statement.values[col_name] = col_value;
+            }
+            else if (col_value == "true" || col_value == "false") {
+                statement.values[col_name] = (col_value == "true");
+            }
+            else {
+                if (!is_numeric(col_value)) {
+                    throw std::runtime_error("Invalid numeric value for column: " + col_name);
+                }
+                statement.values[col_name] = std::stoi(col_value);
+            }
+        }
+    }
+    return statement;
+}
+
+//    EXPLAIN:  SELECT, UPDATE  DELETE -    .
+static std::string explain_statement(Database& db, const std::string& statement) {
+    std::istringstream stream(statement);
+    std::string command, temp, table_name, condition = "true";
+    stream >> command;
+
+    std::ostringstream out;
+    out << "statement: " << command << "\n";
+    SelectStatement select;
+    if (command == "SELECT") {
+        select = parse_select(statement);
+        table_name = select.table_name;
+        condition = select.condition;
+    }
+    else if (command == "DELETE") {
+        stream >> temp >> table_name >> temp;
+        if (temp != "WHERE") throw std::runtime_error("Syntax error: Expected 'WHERE'.");
+        std::getline(stream, condition);
+        condition = trim(condition);
+    }
+    else if (command == "UPDATE") {
+        std::string rest;
+        stream >> table_name;
+        std::getline(stream, rest);
+        size_t where_pos = find_keyword(rest, "WHERE");
+        if (where_pos == std::string::npos) {
+            throw std::runtime_error("Syntax error: Expected 'WHERE' in UPDATE query.");
+        }
+        condition = trim(rest.substr(where_pos + 5));
+    }
+    else {
+        out << "access: none (statement does not scan a table)\n";
+        return out.str();
+    }
+
+    Table* table = db.get_table(table_name);
+    if (!table) throw std::runtime_error("Table not found: " + table_name);
+    out << "table: " << table_name << "\n";
+    if (table->is_view()) {
+        out << "materialized view: " << table->get_view_query() << "\n";
+    }
+    double estimated_rows = 0.0;
+    if (table->is_partitioned()) {
+        //     ,   
+        const PartitionScheme& partitioning = table->get_partitioning();
+        std::vector<size_t> selected = table->partitions_for(condition);
+        out << "partitioning: " << describe_partitioning(partitioning) << "\n"
+            << "partitions: " << selected.size() << " of " << partition_count(partitioning) << " scanned\n";
+        for (size_t index : selected) {
+            const Table& partition = table->get_partition(index);
+            QueryPlan plan = partition.plan_query(condition);
+            out << "partition " << index << ":\n" << describe_plan(plan, partition.row_count());
+            estimated_rows += plan.estimated_rows;
+        }
+    }
+    else {
+        QueryPlan plan = table->plan_query(condition);
+        out << describe_plan(plan, table->row_count());
+        estimated_rows = plan.estimated_rows;
+    }
+
+    const SelectOrder& order = select.order;
+    if (!order.keys.empty()) {
+        out << "order by: ";
+        for (size_t i = 0; i < order.keys.size(); ++i) {
+            out << (i > 0 ? ", " : "") << order.keys[i].column << (order.keys[i].descending ? " DESC" : "");
+        }
+        //    :       
+        size_t entry_bytes = 32 + order.keys.size() * 32;
+        SortMethod method = predict_sort_method(static_cast<size_t>(estimated_rows + 0.5), order.offset,
+            order.limit, entry_bytes, db.get_sort_options());
+        out << "\nsort: " << sort_method_name(method) << "\n";
+    }
+    if (order.limit != std::numeric_limits<size_t>::max() || order.offset > 0) {
+        out << "limit: ";
+        if (order.limit == std::numeric_limits<size_t>::max()) {
+            out << "all";
+        }
+        else {
+            out << order.limit;
+        }
+        out << ", offset: " << order.offset << "\n";
+    }
+    return out.str();
+}
 
 std::string QueryProcessor::parse_and_execute(Database& db, const std::string& query) {
     std::istringstream stream(query);
@@ -35,69 +356,138 @@ std::string QueryProcessor::parse_and_execute(Database& db, const std::string& q
                 schema[col_name] = col_type;
             }
 
-            db.create_table(table_name, schema);
+            PartitionScheme partitioning;
+            std::string partition_def;
+            std::getline(stream, partition_def);
+            if (!trim(partition_def).empty()) {
+                partitioning = parse_partitioning(partition_def);
+            }
+
+            db.create_table(table_name, schema, partitioning);
             std::cout << "Table created: " << table_name << std::endl;
             return "Table " + table_name + " created.";
         }
-    }
-    else if (command == "INSERT") {
-        std::string temp, table_name, values_def;
-        stream >> temp; // TO
-        if (temp != "TO") throw std::runtime_error("Syntax error: Expected 'TO' after INSERT.");
-
-        stream >> table_name;
-
-        std::getline(stream, values_def, '(');
-        std::getline(stream, values_def, ')');
-        values_def = trim(values_def);
+        else if (temp == "MATERIALIZED") {
+            std::string view_kw, view_name, as_kw, select;
+            stream >> view_kw >> view_name >> as_kw;
+            if (view_kw != "VIEW" || view_name.empty() || as_kw != "AS") {
+                throw std::runtime_error("Syntax error: Expected 'CREATE MATERIALIZED VIEW <name> AS SELECT ...'.");
+            }
+            std::getline(stream, select);
 
-        if (values_def.empty()) {
-            throw std::runtime_error("No values specified for INSERT.");
+            db.create_materialized_view(view_name, trim(select));
+            std::cout << "Materialized view created: " << view_name << std::endl;
+            return "Materialized view " + view_name + " created.";
         }
-
-        std::istringstream values_stream(values_def);
-        std::map<std::string, std::any> values;
-        std::string value;
-        while (std::getline(values_stream, value, ',')) {
-            auto equals_pos = value.find('=');
-            if (equals_pos != std::string::npos) {
-                std::string col_name = trim(value.substr(0, equals_pos));
-                std::string col_value = trim(value.substr(equals_pos + 1));
-
-                if (col_value.empty()) {
-                    throw std::runtime_error("Empty value for column: " + col_name);
+        else if (temp == "INDEX") {
+            std::string table_name, column_list;
+            stream >> temp >> table_name; // ON
+            if (temp != "ON") throw std::runtime_error("Syntax error: Expected 'ON' after CREATE INDEX.");
+
+            std::getline(stream, column_list, '(');
+            std::getline(stream, column_list, ')');
+            std::vector<std::string> key_columns = split_list(column_list, "CREATE INDEX");
+
+            // INCLUDE (...) - ,        ;
+            // USING TEXT -   LIKE    , USING BITMAP - 
+            //     AND/OR/NOT  COUNT(*) (  )
+            std::vector<std::string> included_columns;
+            IndexKind kind = IndexKind::Hash;
+            bool kind_given = false;
+            std::string keyword;
+            while (stream >> keyword) {
+                if (keyword == "INCLUDE" && included_columns.empty()) {
+                    std::string list;
+                    std::getline(stream, list, '(');
+                    std::getline(stream, list, ')');
+                    included_columns = split_list(list, "INCLUDE");
                 }
-
-                if (col_value[0] == '\'') {
-                    col_value = col_value.substr(1, col_value.size() - 2);
-                    values[col_name] = col_value;
-                }
-                else if (col_value == "true" || col_value == "false") {
-                    values[col_name] = (col_value == "true");
+                else if (keyword == "USING" && !kind_given) {
+                    std::string kind_name;
+                    stream >> kind_name;
+                    if (kind_name == "TEXT") {
+                        kind = IndexKind::Text;
+                    }
+                    else if (kind_name == "BITMAP") {
+                        kind = IndexKind::Bitmap;
+                    }
+                    else if (kind_name != "HASH") {
+                        throw std::runtime_error("Syntax error: Expected 'USING HASH', 'USING TEXT' or 'USING BITMAP' after CREATE INDEX column.");
+                    }
+                    kind_given = true;
                 }
                 else {
-                    if (!is_numeric(col_value)) {
-                        throw std::runtime_error("Invalid numeric value for column: " + col_name);
-                    }
-                    values[col_name] = std::stoi(col_value);
+                    throw std::runtime_error("Syntax error: Unexpected '" + keyword + "' in CREATE INDEX.");
                 }
             }
+
+            Table* table = db.get_table_for_write(table_name);
+            if (!table) throw std::runtime_error("Table not found: " + table_name);
+
+            std::string index_name;
+            if (key_columns.size() == 1 && included_columns.empty()) {
+                index_name = key_columns[0];
+                table->create_index(index_name, kind);
+            }
+            else {
+                if (kind_given) throw std::runtime_error("USING is supported only for single-column indexes.");
+                index_name = table->create_composite_index(key_columns, included_columns);
+            }
+            std::cout << "Index created on " << table_name << " (" << index_name << ")" << std::endl;
+            return "Index created on " + table_name + " (" + index_name + ").";
+        }
+    }
+    else if (command == "ANALYZE") {
+        std::string table_name;
+        std::vector<std::string> table_names;
+        if (stream >> table_name) {
+            table_names.push_back(table_name);
+        }
+        else {
+            table_names = db.table_names();
         }
 
+        //  ,        
+        std::ostringstream result;
+        for (const auto& name : table_names) {
+            Table* table = db.get_table_for_write(name);
+            if (!table) throw std::runtime_error("Table not found: " + name);
+            table->analyze();
+            result << "table: " << name << "\n" << table->describe_statistics();
+        }
+        return result.str();
+    }
+    else if (command == "SHOW") {
+        std::string temp, table_name;
+        stream >> temp >> table_name;
+        if (temp == "MEMORY") {
+            if (!table_name.empty()) throw std::runtime_error("Syntax error: Unexpected '" + table_name + "' after SHOW MEMORY.");
+            //  ,   ;    
+            return format_memory_report(db.collect_memory_usage());
+        }
+        if (temp != "INDEXES") throw std::runtime_error("Syntax error: Expected 'INDEXES' or 'MEMORY' after SHOW.");
+        if (table_name == "ON" || table_name == "FROM") stream >> table_name;
+
         Table* table = db.get_table(table_name);
         if (!table) throw std::runtime_error("Table not found: " + table_name);
 
-        //  ID
-        if (values.find("id") != values.end()) {
-            int id_value = std::any_cast<int>(values["id"]);
-            if (!table->is_unique("id", id_value)) {
-                throw std::runtime_error("Duplicate ID detected: " + std::to_string(id_value));
-            }
+        //      ,   
+        return table->describe_indices();
+    }
+    else if (command == "INSERT") {
+        InsertStatement insert = parse_insert(query);
+        Table* table = modifiable_table(db, insert.table_name);
+
+        //  ID ( id    )
+        auto id = insert.values.find("id");
+        if (id != insert.values.end() && !table->is_unique("id", id->second)) {
+            throw std::runtime_error("Duplicate ID detected: " + format_literal(id->second));
         }
 
-        table->insert(values);
-        std::cout << "Row inserted into table: " << table_name << std::endl;
-        return "Row inserted into " + table_name + ".";
+        table->insert(insert.values);
+        note_rows_affected(1);
+        std::cout << "Row inserted into table: " << insert.table_name << std::endl;
+        return "Row inserted into " + insert.table_name + ".";
     }
     else if (command == "DELETE") {
         std::string temp, table_name, condition;
@@ -111,10 +501,10 @@ std::string QueryProcessor::parse_and_execute(Database& db, const std::string& q
             throw std::runtime_error("Missing or empty condition in DELETE query.");
         }
 
-        Table* table = db.get_table(table_name);
-        if (!table) throw std::runtime_error("Table not found: " + table_name);
+        Table* table = modifiable_table(db, table_name);
 
-        table->remove(condition);
+        note_rows_affected(table->remove(condition));
+        table->apply_auto_indexing();
         std::cout << "Rows deleted from table: " << table_name << std::endl;
         return "Rows deleted from " + table_name + ".";
     }
@@ -127,116 +517,226 @@ std::string QueryProcessor::parse_and_execute(Database& db, const std::string& q
             throw std::runtime_error("Syntax error: Expected 'SET' after table name in UPDATE query.");
         }
 
-        //       "WHERE"
-        std::getline(stream, updates_str, 'W');
-        updates_str = trim(updates_str); //   
+        //       "WHERE" ( )
+        std::string rest;
+        std::getline(stream, rest);
+        size_t where_pos = find_keyword(rest, "WHERE");
+        if (where_pos == std::string::npos) {
+            throw std::runtime_error("Syntax error: Expected 'WHERE' in UPDATE query.");
+        }
+        updates_str = trim(rest.substr(0, where_pos));
+        condition = trim(rest.substr(where_pos + 5));
 
         if (updates_str.empty()) {
             throw std::runtime_error("Missing update values in UPDATE query.");
         }
-
-        //    "WHERE"
-        std::getline(stream, condition);
-        condition = "W" + condition; //  'W',    
-        condition = trim(condition);
-        if (condition.substr(0, 6) == "WHERE ") {
-            condition = condition.substr(6); //  "WHERE "   
-        }
-
         if (condition.empty()) {
             throw std::runtime_error("Empty condition in UPDATE query.");
         }
 
-        //   
-        std::map<std::string, std::any> updates;
-        std::istringstream updates_stream(updates_str);
-        std::string update;
-        while (std::getline(updates_stream, update, ',')) {
-            auto equals_pos = update.find('=');
-            if (equals_pos == std::string::npos) {
-                throw std::runtime_error("Syntax error in UPDATE values: " + update);
-            }
-
-            std::string col_name = trim(update.substr(0, equals_pos));
-            std::string col_value = trim(update.substr(equals_pos + 1));
-
-            if (col_name.empty()) {
-                throw std::runtime_error("Empty column name in UPDATE values.");
-            }
-
-            //   
-            if (col_value == "NULL" || col_value == "null") {
-                updates[col_name] = std::any(); //    
-            }
-            else if (col_value[0] == '\'' && col_value.back() == '\'') {
-                col_value = col_value.substr(1, col_value.size() - 2); //  
-                updates[col_name] = col_value; //  
-            }
-            else if (col_value == "true" || col_value == "false") {
-                updates[col_name] = (col_value == "true"); //  
-            }
-            else {
-                if (!is_numeric(col_value)) {
-                    throw std::runtime_error("Invalid numeric value in UPDATE for column: " + col_name);
-                }
-                updates[col_name] = std::stoi(col_value); //  
-            }
-        }
+        //  : ,     
+        std::vector<Assignment> updates = parse_assignments(updates_str);
 
         //  
-        Table* table = db.get_table(table_name);
-        if (!table) {
-            throw std::runtime_error("Table not found: " + table_name);
-        }
+        Table* table = modifiable_table(db, table_name);
 
         //  
-        table->update(condition, updates);
+        note_rows_affected(table->update(condition, updates));
+        table->apply_auto_indexing();
 
         std::cout << "Rows updated in table: " << table_name << "\n";
         return "Rows updated in " + table_name + ".";
         }
-    else if (command == "SELECT") {
-        std::string columns, temp, table_name, condition;
-        stream >> columns >> temp >> table_name;
+    else if (command == "COPY") {
+        std::string table_name, direction, filename;
+        stream >> table_name >> direction;
+        std::getline(stream, filename);
+        filename = trim(filename);
+        if (filename.size() < 2 || filename.front() != '\'' || filename.back() != '\'') {
+            throw std::runtime_error("Syntax error: Expected quoted file name in COPY query.");
+        }
+        filename = filename.substr(1, filename.size() - 2);
+
+        if (direction == "FROM") {
+            Table* table = modifiable_table(db, table_name);
 
-        //   WHERE   
-        if (stream >> temp && temp == "WHERE") {
-            std::getline(stream, condition);
-            condition = trim(condition); //   
+            size_t count = import_csv(*table, filename);
+            note_rows_affected(count);
+            std::cout << "Copied " << count << " row(s) into table: " << table_name << std::endl;
+            return "Copied " + std::to_string(count) + " rows into " + table_name + ".";
         }
-        else {
-            condition = "true"; //  WHERE ,   
+        if (direction == "TO") {
+            Table* table = db.get_table(table_name);
+            if (!table) throw std::runtime_error("Table not found: " + table_name);
+
+            size_t count = export_csv(*table, filename);
+            return "Copied " + std::to_string(count) + " rows from " + table_name + ".";
+        }
+        throw std::runtime_error("Syntax error: Expected 'FROM' or 'TO' in COPY query.");
+    }
+    else if (command == "SELECT") {
+        ResultBatch batch = select_batch(db, query);
+        note_rows_affected(batch.row_count);
+        return format_result_batch(batch);
+    }
+    else if (command == "EXPLAIN") {
+        std::string statement;
+        std::getline(stream, statement);
+        statement = trim(statement);
+        bool analyze = statement.compare(0, 8, "ANALYZE ") == 0;
+        if (analyze) {
+            statement = trim(statement.substr(8));
+        }
+        if (statement.empty()) {
+            throw std::runtime_error("Missing statement after EXPLAIN.");
         }
 
-        if (condition.empty()) {
-            throw std::runtime_error("Missing or empty condition in SELECT query.");
+        std::string report = explain_statement(db, statement);
+        if (!analyze) {
+            return report;
         }
 
-        Table* table = db.get_table(table_name);
-        if (!table) throw std::runtime_error("Table not found: " + table_name);
+        // EXPLAIN ANALYZE       
+        QueryProfile profile;
+        std::string result;
+        {
+            ScopedQueryProfile profiling(&profile);
+            ProfileScope total("total");
+            result = parse_and_execute(db, statement);
+            total.set_rows(0, std::count(result.begin(), result.end(), '\n'));
+        }
+        std::string summary = statement.compare(0, 6, "SELECT") == 0
+            ? std::to_string(std::count(result.begin(), result.end(), '\n')) + " row(s)" : result;
+        return report + "result: " + summary + "\n" + format_query_profile(profile);
+    }
+
 
-        auto rows = table->select(condition);
-        std::ostringstream result;
 
-        //   
-        for (const auto& row : rows) {
-            for (const auto& [col_name, value] : row) {
-                if (value.type() == typeid(std::string)) {
-                    result << col_name << ": " << std::any_cast<std::string>(value) << ", ";
+    return "Unknown command.";
+}
+
+// SELECT COUNT(*):     count; LIMIT/OFFSET   .
+static ResultBatch count_batch(Table& table, const SelectStatement& statement) {
+    if (!statement.order.keys.empty()) {
+        throw std::runtime_error("ORDER BY is not supported with COUNT(*).");
+    }
+    size_t count = table.count_rows(statement.condition);
+    if (count > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+        throw std::runtime_error("COUNT(*) result does not fit in int32.");
+    }
+    table.apply_auto_indexing();
+
+    ResultBatch batch;
+    batch.row_count = (statement.order.offset == 0 && statement.order.limit > 0) ? 1 : 0;
+    ColumnBatch column;
+    column.name = "count";
+    column.type = "int32";
+    if (batch.row_count > 0) {
+        column.validity.push_back(1);
+        column.int_values.push_back(static_cast<int32_t>(count));
+    }
+    batch.columns.push_back(std::move(column));
+    return batch;
+}
+
+ResultBatch QueryProcessor::select_batch(Database& db, const std::string& query) {
+    SelectStatement statement = parse_select(query);
+    Table* table = db.get_table(statement.table_name);
+    if (!table) throw std::runtime_error("Table not found: " + statement.table_name);
+
+    if (statement.projection.size() == 1 && statement.projection[0] == "COUNT(*)") {
+        return count_batch(*table, statement);
+    }
+    //      ,       
+    SortOptions sort_options = db.get_sort_options();
+    if (current_query_context && current_query_context->memory_limit) {
+        sort_options.memory_budget = std::min(sort_options.memory_budget, current_query_context->memory_limit / 2);
+    }
+    ResultBatch batch = table->select_batch(statement.condition, statement.projection, statement.order, sort_options);
+    table->apply_auto_indexing();
+    return batch;
+}
+
+static std::string statement_command(const std::string& statement) {
+    std::istringstream stream(statement);
+    std::string command;
+    stream >> command;
+    return command;
+}
+
+std::vector<std::string> QueryProcessor::execute_script(Database& db, const std::vector<std::string>& statements,
+    const std::function<void()>& refresh_views) {
+    std::vector<std::string> results;
+    results.reserve(statements.size());
+    size_t i = 0;
+    while (i < statements.size()) {
+        if (statement_command(statements[i]) != "INSERT") {
+            refresh_views();
+            results.push_back(parse_and_execute(db, statements[i]));
+            ++i;
+            continue;
+        }
+
+        //   INSERT   :    , 
+        //   , ID   ,   
+        InsertStatement insert = parse_insert(statements[i]);
+        const std::string table_name = insert.table_name;
+        Table* table = modifiable_table(db, table_name);
+        const auto& columns = table->get_columns();
+        std::vector<std::vector<Value>> batch;
+        std::unordered_set<int> ids;
+        bool ids_loaded = false;
+        bool int_ids = false;
+        std::unordered_set<std::string> batch_ids;   // ID  ,   
+        while (true) {
+            auto id = insert.values.find("id");
+            if (id != insert.values.end()) {
+                if (!ids_loaded) {
+                    int_ids = table->get_column_type("id") == "int32";
+                    if (int_ids) {
+                        ResultBatch existing = table->scan_batch(0, table->row_count(), { "id" });
+                        for (size_t r = 0; r < existing.row_count; ++r) {
+                            if (existing.columns[0].is_valid(r)) {
+                                ids.insert(existing.columns[0].int_at(r));
+                            }
+                        }
+                    }
+                    ids_loaded = true;
                 }
-                else if (value.type() == typeid(int)) {
-                    result << col_name << ": " << std::any_cast<int>(value) << ", ";
+                if (int_ids && id->second.is_int()) {
+                    if (!ids.insert(id->second.as_int()).second) {
+                        throw std::runtime_error("Duplicate ID detected: " + format_literal(id->second));
+                    }
                 }
-                else if (value.type() == typeid(bool)) {
-                    result << col_name << ": " << (std::any_cast<bool>(value) ? "true" : "false") << ", ";
+                else if (!batch_ids.insert(format_literal(id->second)).second || !table->is_unique("id", id->second)) {
+                    //    -  ,    INSERT
+                    throw std::runtime_error("Duplicate ID detected: " + format_literal(id->second));
                 }
             }
-            result << "\n";
-        }
-        return result.str();
-    }
-
 
+            //     ,    Table::insert
+            std::vector<Value> row(columns.size());
+            for (size_t c = 0; c < columns.size(); ++c) {
+                auto value = insert.values.find(columns[c]);
+                if (value != insert.values.end()) {
+                    row[c] = std::move(value->second);
+                }
+            }
+            batch.push_back(std::move(row));
+            results.push_back("Row inserted into " + table_name + ".");
+            ++i;
 
-    return "Unknown command.";
+            if (i == statements.size() || statement_command(statements[i]) != "INSERT") {
+                break;
+            }
+            insert = parse_insert(statements[i]);
+            if (insert.table_name != table_name) {
+                break;
+            }
+        }
+        size_t inserted = batch.size();
+        table->insert_batch(std::move(batch));
+        note_rows_affected(inserted);
+    }
+    return results;
 }
@@ -1,9 +1,21 @@
 #pragma once
+#include <functional>
 #include <string>
+#include <vector>
+#include "result_batch.h"
 
 class Database; //  
 
 class QueryProcessor {
 public:
     static std::string parse_and_execute(Database& db, const std::string& query);
+
+    //  SELECT         .
+    static ResultBatch select_batch(Database& db, const std::string& query);
+
+    //        .   INSERT
+    //        Table::insert_batch.  
+    //    refresh_views,     .
+    static std::vector<std::string> execute_script(Database& db, const std::vector<std::string>& statements,
+        const std::function<void()>& refresh_views);
 };
@@ -0,0 +1,54 @@
+#include "query_profile.h"
+#include <iomanip>
+#include <sstream>
+
+ProfileScope::ProfileScope(const char* name, std::string detail)
+    : profile(current_query_profile), context(current_query_context) {
+    if (!profile) {
+        return;
+    }
+    record.name = name;
+    record.detail = std::move(detail);
+    //     ,    
+    if (context) {
+        outer_peak = context->memory_peak.exchange(context->memory_in_use(), std::memory_order_relaxed);
+    }
+    started = std::chrono::steady_clock::now();
+}
+
+ProfileScope::~ProfileScope() {
+    if (!profile) {
+        return;
+    }
+    record.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - started).count();
+    if (context) {
+        record.peak_memory_bytes = context->memory_peak.load(std::memory_order_relaxed);
+        context->raise_memory_peak(outer_peak);
+    }
+    profile->operators.push_back(std::move(record));
+}
+
+void ProfileScope::set_rows(size_t rows_in, size_t rows_out) {
+    record.rows_in = rows_in;
+    record.rows_out = rows_out;
+}
+
+void ProfileScope::set_detail(std::string detail) {
+    record.detail = std::move(detail);
+}
+
+std::string format_query_profile(const QueryProfile& profile) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    for (const auto& op : profile.operators) {
+        out << "operator: " << op.name;
+        if (!op.detail.empty()) {
+            out << " (" << op.detail << ")";
+        }
+        out << ", time: " << op.milliseconds << " ms"
+            << ", rows in: " << op.rows_in
+            << ", rows out: " << op.rows_out
+            << ", peak memory: " << op.peak_memory_bytes << " bytes\n";
+    }
+    return out.str();
+}
@@ -0,0 +1,68 @@
+#ifndef QUERY_PROFILE_H
+#define QUERY_PROFILE_H
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "query_context.h"
+
+//      EXPLAIN ANALYZE.
+struct OperatorProfile {
+    std::string name;
+    std::string detail;
+    size_t rows_in = 0;
+    size_t rows_out = 0;
+    double milliseconds = 0.0;
+    //   ,  QueryMemoryCharge,   .
+    size_t peak_memory_bytes = 0;
+};
+
+struct QueryProfile {
+    std::vector<OperatorProfile> operators;
+};
+
+//  ,    (nullptr -  ).
+inline thread_local QueryProfile* current_query_profile = nullptr;
+
+//             
+//     .     .
+class ProfileScope {
+public:
+    ProfileScope(const char* name, std::string detail = std::string());
+    ~ProfileScope();
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+    bool active() const { return profile != nullptr; }
+    void set_rows(size_t rows_in, size_t rows_out);
+    void set_detail(std::string detail);
+
+private:
+    QueryProfile* profile;
+    OperatorProfile record;
+    std::chrono::steady_clock::time_point started;
+    const QueryContext* context;
+    size_t outer_peak = 0;  //       
+};
+
+//          .
+class ScopedQueryProfile {
+public:
+    explicit ScopedQueryProfile(QueryProfile* profile) : previous(current_query_profile) {
+        current_query_profile = profile;
+    }
+    ~ScopedQueryProfile() {
+        current_query_profile = previous;
+    }
+    ScopedQueryProfile(const ScopedQueryProfile&) = delete;
+    ScopedQueryProfile& operator=(const ScopedQueryProfile&) = delete;
+
+private:
+    QueryProfile* previous;
+};
+
+//      ;  -     .
+std::string format_query_profile(const QueryProfile& profile);
+
+#endif // QUERY_PROFILE_H
@@ -0,0 +1,205 @@
+#include "result_batch.h"
+#include <bit>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include "memory_usage.h"
+
+static const char BATCH_MAGIC[] = "RBT1";
+
+size_t ColumnBatch::memory_bytes() const {
+    return vector_bytes(validity) + vector_bytes(int_values) + vector_bytes(bool_values) +
+        vector_bytes(offsets) + string_heap_bytes(string_data);
+}
+
+enum class BatchType : uint8_t { Int32 = 0, Bool = 1, String = 2 };
+
+static BatchType batch_type(const std::string& type) {
+    if (type == "int32") return BatchType::Int32;
+    if (type == "bool") return BatchType::Bool;
+    if (type == "string") return BatchType::String;
+    throw std::runtime_error("Unsupported column type in result batch: " + type);
+}
+
+static std::string batch_type_name(uint8_t code) {
+    switch (static_cast<BatchType>(code)) {
+    case BatchType::Int32: return "int32";
+    case BatchType::Bool: return "bool";
+    case BatchType::String: return "string";
+    }
+    throw std::runtime_error("Corrupted result batch: unknown column type.");
+}
+
+std::string format_result_batch(const ResultBatch& batch) {
+    std::ostringstream result;
+    for (size_t row = 0; row < batch.row_count; ++row) {
+        for (const auto& column : batch.columns) {
+            if (!column.is_valid(row)) {
+                continue;
+            }
+            result << column.name << ": ";
+            if (column.type == "int32") {
+                result << column.int_at(row);
+            }
+            else if (column.type == "bool") {
+                result << (column.bool_at(row) ? "true" : "false");
+            }
+            else {
+                result.write(column.string_data.data() + column.offsets[row], column.offsets[row + 1] - column.offsets[row]);
+            }
+            result << ", ";
+        }
+        result << "\n";
+    }
+    return result.str();
+}
+
+//     - little-endian.
+static void put_u64(std::ostream& out, uint64_t value) {
+    char bytes[8];
+    for (int i = 0; i < 8; ++i) {
+        bytes[i] = static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+    out.write(bytes, 8);
+}
+
+static uint64_t get_u64(std::istream& in) {
+    unsigned char bytes[8];
+    if (!in.read(reinterpret_cast<char*>(bytes), 8)) {
+        throw std::runtime_error("Corrupted result batch: unexpected end of data.");
+    }
+    uint64_t value = 0;
+    for (int i = 0; i < 8; ++i) {
+        value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
+    }
+    return value;
+}
+
+// :     ,     8.
+static void put_buffer(std::ostream& out, const void* data, size_t size) {
+    static const char padding[8] = {};
+    put_u64(out, size);
+    out.write(static_cast<const char*>(data), size);
+    out.write(padding, (8 - size % 8) % 8);
+}
+
+static std::string get_buffer(std::istream& in) {
+    uint64_t size = get_u64(in);
+    std::string data(size + (8 - size % 8) % 8, '\0');
+    if (!in.read(data.data(), data.size())) {
+        throw std::runtime_error("Corrupted result batch: unexpected end of data.");
+    }
+    data.resize(size);
+    return data;
+}
+
+static void put_int_buffer(std::ostream& out, const std::vector<int32_t>& values) {
+    if constexpr (std::endian::native == std::endian::little) {
+        put_buffer(out, values.data(), values.size() * sizeof(int32_t));
+    }
+    else {
+        std::string bytes;
+        for (int32_t value : values) {
+            for (int i = 0; i < 4; ++i) {
+                bytes += static_cast<char>((static_cast<uint32_t>(value) >> (8 * i)) & 0xFF);
+            }
+        }
+        put_buffer(out, bytes.data(), bytes.size());
+    }
+}
+
+static std::vector<int32_t> get_int_buffer(std::istream& in, size_t expected) {
+    std::string bytes = get_buffer(in);
+    if (bytes.size() != expected * sizeof(int32_t)) {
+        throw std::runtime_error("Corrupted result batch: wrong buffer size.");
+    }
+    std::vector<int32_t> values(expected);
+    for (size_t i = 0; i < expected; ++i) {
+        uint32_t value = 0;
+        for (int b = 0; b < 4; ++b) {
+            value |= static_cast<uint32_t>(static_cast<unsigned char>(bytes[i * 4 + b])) << (8 * b);
+        }
+        values[i] = static_cast<int32_t>(value);
+    }
+    return values;
+}
+
+static std::vector<uint8_t> get_bitmap(std::istream& in, size_t rows) {
+    std::string bytes = get_buffer(in);
+    if (bytes.size() != (rows + 7) / 8) {
+        throw std::runtime_error("Corrupted result batch: wrong bitmap size.");
+    }
+    return std::vector<uint8_t>(bytes.begin(), bytes.end());
+}
+
+// : "RBT1",  ,  ;    ,  ,
+//  NULL   (validity,       ).
+void write_result_batch(std::ostream& out, const ResultBatch& batch) {
+    out.write(BATCH_MAGIC, 4);
+    put_u64(out, batch.columns.size());
+    put_u64(out, batch.row_count);
+    for (const auto& column : batch.columns) {
+        BatchType type = batch_type(column.type);
+        put_buffer(out, column.name.data(), column.name.size());
+        put_u64(out, static_cast<uint64_t>(type));
+        put_u64(out, column.null_count);
+        put_buffer(out, column.validity.data(), column.validity.size());
+        switch (type) {
+        case BatchType::Int32:
+            put_int_buffer(out, column.int_values);
+            break;
+        case BatchType::Bool:
+            put_buffer(out, column.bool_values.data(), column.bool_values.size());
+            break;
+        case BatchType::String:
+            put_int_buffer(out, column.offsets);
+            put_buffer(out, column.string_data.data(), column.string_data.size());
+            break;
+        }
+    }
+    if (!out) {
+        throw std::runtime_error("Failed to write result batch.");
+    }
+}
+
+ResultBatch read_result_batch(std::istream& in) {
+    char magic[4];
+    if (!in.read(magic, 4) || std::string(magic, 4) != BATCH_MAGIC) {
+        throw std::runtime_error("Not a result batch.");
+    }
+    ResultBatch batch;
+    uint64_t column_count = get_u64(in);
+    batch.row_count = get_u64(in);
+    for (uint64_t c = 0; c < column_count; ++c) {
+        ColumnBatch column;
+        column.name = get_buffer(in);
+        uint64_t code = get_u64(in);
+        column.type = batch_type_name(static_cast<uint8_t>(code));
+        column.null_count = get_u64(in);
+        column.validity = get_bitmap(in, batch.row_count);
+        switch (static_cast<BatchType>(code)) {
+        case BatchType::Int32:
+            column.int_values = get_int_buffer(in, batch.row_count);
+            break;
+        case BatchType::Bool:
+            column.bool_values = get_bitmap(in, batch.row_count);
+            break;
+        case BatchType::String:
+            column.offsets = get_int_buffer(in, batch.row_count + 1);
+            column.string_data = get_buffer(in);
+            for (size_t i = 0; i < column.offsets.size(); ++i) {
+                int32_t previous = (i == 0) ? 0 : column.offsets[i - 1];
+                if (column.offsets[i] < previous) {
+                    throw std::runtime_error("Corrupted result batch: string offsets out of range.");
+                }
+            }
+            if (column.offsets.back() != static_cast<int32_t>(column.string_data.size())) {
+                throw std::runtime_error("Corrupted result batch: string offsets out of range.");
+            }
+            break;
+        }
+        batch.columns.push_back(std::move(column));
+    }
+    return batch;
+}
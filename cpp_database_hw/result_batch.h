@@ -0,0 +1,45 @@
+#ifndef RESULT_BATCH_H
+#define RESULT_BATCH_H
+
+#include <cstdint>
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+//      (    Apache Arrow).
+//  :  i -  i,   .
+struct ColumnBatch {
+    std::string name;
+    std::string type;                  // "int32", "string"  "bool"
+    size_t null_count = 0;
+    std::vector<uint8_t> validity;     // 1 -  , 0 - NULL
+    std::vector<int32_t> int_values;   // int32:  (NULL - )
+    std::vector<uint8_t> bool_values;  // bool:   
+    std::vector<int32_t> offsets;      // string: row_count + 1   string_data
+    std::string string_data;           // string:    
+
+    bool is_valid(size_t row) const { return (validity[row / 8] >> (row % 8)) & 1; }
+    int32_t int_at(size_t row) const { return int_values[row]; }
+    bool bool_at(size_t row) const { return (bool_values[row / 8] >> (row % 8)) & 1; }
+    std::string string_at(size_t row) const {
+        return string_data.substr(offsets[row], offsets[row + 1] - offsets[row]);
+    }
+
+    size_t memory_bytes() const;
+};
+
+//  SELECT:    .
+struct ResultBatch {
+    size_t row_count = 0;
+    std::vector<ColumnBatch> columns;
+};
+
+//     "col: value, "   (NULL ).
+std::string format_result_batch(const ResultBatch& batch);
+
+//  :        8 ,
+//            .
+void write_result_batch(std::ostream& out, const ResultBatch& batch);
+ResultBatch read_result_batch(std::istream& in);
+
+#endif // RESULT_BATCH_H
@@ -0,0 +1,101 @@
+#include "result_cache.h"
+#include <cctype>
+#include <iterator>
+
+//     :  ,       .
+static const size_t ENTRY_OVERHEAD = 128;
+
+void ResultCache::set_capacity(size_t bytes) {
+    std::lock_guard<std::mutex> lock(mutex);
+    capacity = bytes;
+    evict_to(capacity);
+}
+
+bool ResultCache::enabled() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return capacity > 0;
+}
+
+bool ResultCache::lookup(const std::string& key, uint64_t version, std::string& result, size_t& rows) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = by_key.find(key);
+    if (it == by_key.end()) {
+        ++stats.misses;
+        return false;
+    }
+    if (it->second->version != version) {
+        erase(it->second);
+        ++stats.invalidations;
+        ++stats.misses;
+        return false;
+    }
+    entries.splice(entries.begin(), entries, it->second);
+    result = it->second->result;
+    rows = it->second->rows;
+    ++stats.hits;
+    return true;
+}
+
+void ResultCache::store(const std::string& key, uint64_t version, const std::string& result, size_t rows) {
+    std::lock_guard<std::mutex> lock(mutex);
+    size_t bytes = 2 * key.size() + result.size() + ENTRY_OVERHEAD;
+    if (bytes > capacity) {
+        return;
+    }
+    auto it = by_key.find(key);
+    if (it != by_key.end()) {
+        erase(it->second);
+    }
+    evict_to(capacity - bytes);
+    entries.push_front({ key, version, result, rows, bytes });
+    by_key[key] = entries.begin();
+    stats.bytes += bytes;
+    ++stats.entries;
+}
+
+void ResultCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    by_key.clear();
+    stats.entries = 0;
+    stats.bytes = 0;
+}
+
+ResultCacheStats ResultCache::get_stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+void ResultCache::erase(std::list<Entry>::iterator it) {
+    stats.bytes -= it->bytes;
+    --stats.entries;
+    by_key.erase(it->key);
+    entries.erase(it);
+}
+
+void ResultCache::evict_to(size_t limit) {
+    while (stats.bytes > limit && !entries.empty()) {
+        erase(std::prev(entries.end()));
+        ++stats.evictions;
+    }
+}
+
+std::string normalize_statement(const std::string& query) {
+    std::string result;
+    bool in_quotes = false, pending_space = false;
+    for (char c : query) {
+        if (!in_quotes && std::isspace(static_cast<unsigned char>(c))) {
+            pending_space = !result.empty();
+            continue;
+        }
+        if (pending_space) {
+            result += ' ';
+            pending_space = false;
+        }
+        if (c == '\'') {
+            in_quotes = !in_quotes;
+        }
+        result += c;
+    }
+    return result;
+}
@@ -0,0 +1,57 @@
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+//   .
+struct ResultCacheStats {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t invalidations = 0;   // ,  -  
+    size_t evictions = 0;       // ,    
+    size_t entries = 0;
+    size_t bytes = 0;
+};
+
+//    SELECT.  ,   
+//      ;    
+//      (LRU). .
+class ResultCache {
+public:
+    //       .
+    void set_capacity(size_t bytes);
+    bool enabled() const;
+
+    // rows -    (  ).
+    bool lookup(const std::string& key, uint64_t version, std::string& result, size_t& rows);
+    void store(const std::string& key, uint64_t version, const std::string& result, size_t rows);
+    void clear();
+    ResultCacheStats get_stats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        uint64_t version = 0;
+        std::string result;
+        size_t rows = 0;
+        size_t bytes = 0;
+    };
+
+    mutable std::mutex mutex;
+    size_t capacity = 0;
+    std::list<Entry> entries;   //   -  
+    std::unordered_map<std::string, std::list<Entry>::iterator> by_key;
+    ResultCacheStats stats;
+
+    void erase(std::list<Entry>::iterator it);
+    void evict_to(size_t limit);
+};
+
+//        :  .
+std::string normalize_statement(const std::string& query);
+
+#endif // RESULT_CACHE_H
@@ -0,0 +1,61 @@
+#include "row_store.h"
+#include "memory_usage.h"
+
+RowStore::Block& RowStore::writable_block(size_t block) {
+    if (blocks[block].use_count() > 1) {
+        blocks[block] = std::make_shared<Block>(*blocks[block]);
+    }
+    return *blocks[block];
+}
+
+RowStore::Row& RowStore::mutable_row(size_t position) {
+    return writable_block(position / BLOCK_ROWS)[position % BLOCK_ROWS];
+}
+
+void RowStore::push_back(Row row) {
+    if (row_count % BLOCK_ROWS == 0) {
+        blocks.push_back(std::make_shared<Block>());
+    }
+    writable_block(blocks.size() - 1).push_back(std::move(row));
+    ++row_count;
+}
+
+void RowStore::pop_back() {
+    --row_count;
+    if (row_count % BLOCK_ROWS == 0) {
+        blocks.pop_back();
+        return;
+    }
+    writable_block(blocks.size() - 1).pop_back();
+}
+
+void RowStore::resize(size_t count, const Row& fill) {
+    if (count >= row_count) {
+        while (row_count < count) {
+            push_back(fill);
+        }
+        return;
+    }
+    //    ,   
+    blocks.resize((count + BLOCK_ROWS - 1) / BLOCK_ROWS);
+    row_count = count;
+    if (count % BLOCK_ROWS != 0) {
+        writable_block(blocks.size() - 1).resize(count % BLOCK_ROWS);
+    }
+}
+
+void RowStore::clear() {
+    blocks.clear();
+    row_count = 0;
+}
+
+size_t RowStore::container_bytes() const {
+    size_t bytes = vector_bytes(blocks);
+    for (const auto& block : blocks) {
+        bytes += sizeof(Block) + vector_bytes(*block);
+        for (const auto& row : *block) {
+            bytes += vector_bytes(row);
+        }
+    }
+    return bytes;
+}
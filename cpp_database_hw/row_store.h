@@ -0,0 +1,66 @@
+#ifndef ROW_STORE_H
+#define ROW_STORE_H
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include "value.h"
+
+//     BLOCK_ROWS (  ,     ZoneMap).
+//      (, ):  
+//    ,      .
+class RowStore {
+public:
+    using Row = std::vector<Value>;
+    static const size_t BLOCK_ROWS = 1024;
+
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Row;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Row*;
+        using reference = const Row&;
+
+        const_iterator(const RowStore* store, size_t position) : store(store), position(position) {}
+
+        reference operator*() const { return (*store)[position]; }
+        pointer operator->() const { return &(*store)[position]; }
+        const_iterator& operator++() { ++position; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; ++position; return old; }
+        bool operator==(const const_iterator& other) const { return position == other.position; }
+        bool operator!=(const const_iterator& other) const { return position != other.position; }
+
+    private:
+        const RowStore* store;
+        size_t position;
+    };
+
+    size_t size() const { return row_count; }
+    bool empty() const { return row_count == 0; }
+    const Row& operator[](size_t position) const { return (*blocks[position / BLOCK_ROWS])[position % BLOCK_ROWS]; }
+    const Row& back() const { return (*this)[row_count - 1]; }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, row_count); }
+
+    //   :       .
+    Row& mutable_row(size_t position);
+    void push_back(Row row);
+    void pop_back();
+    //   count      fill.
+    void resize(size_t count, const Row& fill = {});
+    void clear();
+
+    //         .
+    size_t container_bytes() const;
+
+private:
+    using Block = std::vector<Row>;
+    std::vector<std::shared_ptr<Block>> blocks;  //  ,  , 
+    size_t row_count = 0;
+
+    Block& writable_block(size_t block);
+};
+
+#endif // ROW_STORE_H
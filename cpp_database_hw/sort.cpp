@@ -0,0 +1,343 @@
+#include "sort.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include "encoding.h"
+#include "planner.h"
+#include "query_context.h"
+
+//      ,        .
+static const size_t MIN_RUN_ENTRIES = 1024;
+
+namespace {
+
+//   :   ORDER BY     .
+struct SortEntry {
+    size_t position = 0;
+    std::vector<Value> values;
+};
+
+//  :   ,   -  .
+class EntryLess {
+public:
+    explicit EntryLess(const std::vector<bool>& descending) : descending(&descending) {}
+
+    bool operator()(const SortEntry& left, const SortEntry& right) const {
+        for (size_t i = 0; i < left.values.size(); ++i) {
+            int result = compare_cells(left.values[i], right.values[i]);
+            if (result != 0) {
+                return (*descending)[i] ? result > 0 : result < 0;
+            }
+        }
+        return left.position < right.position;
+    }
+
+private:
+    const std::vector<bool>* descending;
+};
+
+SortEntry make_entry(const RowRefs& rows, size_t position, const std::vector<std::pair<size_t, bool>>& keys) {
+    SortEntry entry;
+    entry.position = position;
+    entry.values.reserve(keys.size());
+    for (const auto& [column, descending] : keys) {
+        entry.values.push_back((*rows[position])[column]);
+    }
+    return entry;
+}
+
+size_t entry_bytes(const SortEntry& entry) {
+    size_t bytes = sizeof(SortEntry) + entry.values.capacity() * sizeof(Value);
+    for (const auto& value : entry.values) {
+        bytes += value.heap_bytes();
+    }
+    return bytes;
+}
+
+//  :   (varint),      .
+enum class SpillTag : uint8_t { Null = 0, Int = 1, String = 2, Bool = 3 };
+
+void write_entry(std::ostream& out, const SortEntry& entry) {
+    ByteWriter record;
+    record.put_varint(entry.position);
+    for (const auto& value : entry.values) {
+        if (!value.has_value()) {
+            record.put_byte(static_cast<uint8_t>(SpillTag::Null));
+        }
+        else if (value.is_int()) {
+            record.put_byte(static_cast<uint8_t>(SpillTag::Int));
+            record.put_signed(value.as_int());
+        }
+        else if (value.is_string()) {
+            record.put_byte(static_cast<uint8_t>(SpillTag::String));
+            record.put_string(value.as_string());
+        }
+        else {
+            record.put_byte(static_cast<uint8_t>(SpillTag::Bool));
+            record.put_byte(value.as_bool() ? 1 : 0);
+        }
+    }
+    ByteWriter length;
+    length.put_varint(record.data().size());
+    out.write(length.data().data(), length.data().size());
+    out.write(record.data().data(), record.data().size());
+}
+
+bool read_entry(std::istream& in, size_t key_count, SortEntry& entry) {
+    uint64_t length = 0;
+    int shift = 0;
+    while (true) {
+        int byte = in.get();
+        if (byte == EOF) {
+            if (shift == 0) {
+                return false;
+            }
+            throw std::runtime_error("Corrupted sort spill file.");
+        }
+        length |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        shift += 7;
+        if (!(byte & 0x80)) {
+            break;
+        }
+    }
+    std::string data(length, '\0');
+    if (!in.read(data.data(), length)) {
+        throw std::runtime_error("Corrupted sort spill file.");
+    }
+
+    ByteReader record(data);
+    entry.position = record.get_varint();
+    entry.values.assign(key_count, Value());
+    for (size_t i = 0; i < key_count; ++i) {
+        switch (static_cast<SpillTag>(record.get_byte())) {
+        case SpillTag::Null:
+            break;
+        case SpillTag::Int:
+            entry.values[i] = static_cast<int>(record.get_signed());
+            break;
+        case SpillTag::String:
+            entry.values[i] = record.get_string();
+            break;
+        case SpillTag::Bool:
+            entry.values[i] = record.get_byte() != 0;
+            break;
+        default:
+            throw std::runtime_error("Corrupted sort spill file.");
+        }
+    }
+    return true;
+}
+
+//     ;     .
+class SpillRun {
+public:
+    SpillRun(const std::filesystem::path& path, const std::vector<SortEntry>& entries) : path(path) {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            throw std::runtime_error("Cannot create sort spill file: " + path.string());
+        }
+        for (const auto& entry : entries) {
+            write_entry(out, entry);
+        }
+        if (!out) {
+            throw std::runtime_error("Failed to write sort spill file: " + path.string());
+        }
+    }
+    ~SpillRun() {
+        in.close();
+        std::error_code error;
+        std::filesystem::remove(path, error);
+    }
+    SpillRun(const SpillRun&) = delete;
+    SpillRun& operator=(const SpillRun&) = delete;
+
+    void open() {
+        in.open(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("Cannot open sort spill file: " + path.string());
+        }
+    }
+    bool next(size_t key_count, SortEntry& entry) { return read_entry(in, key_count, entry); }
+
+private:
+    std::filesystem::path path;
+    std::ifstream in;
+};
+
+std::filesystem::path spill_path(const SortOptions& options) {
+    //         
+    static const std::string process_tag = std::to_string(std::random_device{}());
+    static std::atomic<size_t> counter{ 0 };
+    std::filesystem::path directory = options.temp_directory.empty()
+        ? std::filesystem::temp_directory_path() : std::filesystem::path(options.temp_directory);
+    return directory / ("cppdb_sort_" + process_tag + "_" + std::to_string(counter++) + ".run");
+}
+
+std::vector<size_t> window(const std::vector<SortEntry>& sorted, size_t offset, size_t limit) {
+    std::vector<size_t> result;
+    for (size_t i = offset; i < sorted.size() && result.size() < limit; ++i) {
+        result.push_back(sorted[i].position);
+    }
+    return result;
+}
+
+}
+
+const char* sort_method_name(SortMethod method) {
+    switch (method) {
+    case SortMethod::None: return "none";
+    case SortMethod::TopK: return "top-k heap";
+    case SortMethod::InMemory: return "in-memory sort";
+    case SortMethod::External: return "external merge sort";
+    }
+    return "?";
+}
+
+// Top-k ,          .
+static bool use_top_k(size_t input_rows, size_t k, size_t entry_bytes, const SortOptions& options) {
+    return k <= input_rows / 4 && k * entry_bytes <= options.memory_budget;
+}
+
+SortMethod predict_sort_method(size_t input_rows, size_t offset, size_t limit, size_t entry_bytes,
+    const SortOptions& options) {
+    if (limit == 0 || offset >= input_rows) {
+        return SortMethod::None;
+    }
+    size_t k = (limit > input_rows - offset) ? input_rows : offset + limit;
+    if (use_top_k(input_rows, k, entry_bytes, options)) {
+        return SortMethod::TopK;
+    }
+    return input_rows * entry_bytes > options.memory_budget ? SortMethod::External : SortMethod::InMemory;
+}
+
+std::vector<size_t> sort_rows(const RowRefs& rows, const std::vector<std::pair<size_t, bool>>& keys,
+    size_t offset, size_t limit,
+    const SortOptions& options, SortMethod* method) {
+    auto report = [method](SortMethod used) {
+        if (method) {
+            *method = used;
+        }
+        };
+
+    if (keys.empty()) {
+        //  LIMIT/OFFSET:   
+        report(SortMethod::None);
+        std::vector<size_t> result;
+        for (size_t i = offset; i < rows.size() && result.size() < limit; ++i) {
+            result.push_back(i);
+        }
+        return result;
+    }
+    if (limit == 0 || offset >= rows.size()) {
+        report(SortMethod::None);
+        return {};
+    }
+
+    std::vector<bool> descending;
+    for (const auto& key : keys) {
+        descending.push_back(key.second);
+    }
+    EntryLess less(descending);
+    //    (   )    
+    QueryMemoryCharge memory;
+
+    // Top-k:   offset + limit  
+    size_t k = (limit > rows.size() - offset) ? rows.size() : offset + limit;
+    size_t estimated_entry = entry_bytes(make_entry(rows, 0, keys));
+    if (use_top_k(rows.size(), k, estimated_entry, options)) {
+        report(SortMethod::TopK);
+        std::priority_queue<SortEntry, std::vector<SortEntry>, EntryLess> heap(less);
+        for (size_t i = 0; i < rows.size(); ++i) {
+            if ((i & 1023) == 0) {
+                check_query_interrupted();
+                memory.set(heap.size() * estimated_entry);
+            }
+            SortEntry entry = make_entry(rows, i, keys);
+            if (heap.size() < k) {
+                heap.push(std::move(entry));
+            }
+            else if (less(entry, heap.top())) {
+                heap.pop();
+                heap.push(std::move(entry));
+            }
+        }
+        std::vector<SortEntry> sorted(heap.size());
+        for (size_t i = sorted.size(); i-- > 0;) {
+            sorted[i] = heap.top();
+            heap.pop();
+        }
+        return window(sorted, offset, limit);
+    }
+
+    //     ,       
+    std::vector<std::unique_ptr<SpillRun>> runs;
+    std::vector<SortEntry> entries;
+    size_t used_bytes = 0;
+    for (size_t i = 0; i < rows.size(); ++i) {
+        if ((i & 1023) == 0) {
+            check_query_interrupted();
+            memory.set(used_bytes);
+        }
+        entries.push_back(make_entry(rows, i, keys));
+        used_bytes += entry_bytes(entries.back());
+        if (used_bytes > options.memory_budget && entries.size() >= MIN_RUN_ENTRIES) {
+            std::sort(entries.begin(), entries.end(), less);
+            runs.push_back(std::make_unique<SpillRun>(spill_path(options), entries));
+            entries.clear();
+            used_bytes = 0;
+            memory.set(0);
+        }
+    }
+    if (runs.empty()) {
+        report(SortMethod::InMemory);
+        std::sort(entries.begin(), entries.end(), less);
+        //    :       
+        check_query_interrupted();
+        return window(entries, offset, limit);
+    }
+    if (!entries.empty()) {
+        std::sort(entries.begin(), entries.end(), less);
+        runs.push_back(std::make_unique<SpillRun>(spill_path(options), entries));
+        entries.clear();
+    }
+
+    //  :        
+    report(SortMethod::External);
+    auto greater = [&less](const std::pair<SortEntry, size_t>& left, const std::pair<SortEntry, size_t>& right) {
+        return less(right.first, left.first);
+        };
+    std::priority_queue<std::pair<SortEntry, size_t>, std::vector<std::pair<SortEntry, size_t>>, decltype(greater)> heads(greater);
+    for (size_t r = 0; r < runs.size(); ++r) {
+        runs[r]->open();
+        SortEntry entry;
+        if (runs[r]->next(keys.size(), entry)) {
+            heads.emplace(std::move(entry), r);
+        }
+    }
+
+    std::vector<size_t> result;
+    size_t skipped = 0;
+    while (!heads.empty() && result.size() < limit) {
+        if (((skipped + result.size()) & 1023) == 0) {
+            check_query_interrupted();
+        }
+        auto [entry, r] = heads.top();
+        heads.pop();
+        if (skipped < offset) {
+            ++skipped;
+        }
+        else {
+            result.push_back(entry.position);
+        }
+        SortEntry next;
+        if (runs[r]->next(keys.size(), next)) {
+            heads.emplace(std::move(next), r);
+        }
+    }
+    return result;
+}
@@ -0,0 +1,49 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include <limits>
+#include <string>
+#include <vector>
+#include "value.h"
+
+//  ORDER BY.
+struct OrderKey {
+    std::string column;
+    bool descending = false;
+};
+
+// ORDER BY ... LIMIT n OFFSET m.
+struct SelectOrder {
+    std::vector<OrderKey> keys;
+    size_t limit = std::numeric_limits<size_t>::max();
+    size_t offset = 0;
+
+    bool empty() const { return keys.empty() && limit == std::numeric_limits<size_t>::max() && offset == 0; }
+};
+
+//     ;    
+//      .
+struct SortOptions {
+    size_t memory_budget = 64 << 20;
+    std::string temp_directory;    //  -    
+};
+
+// ,      (   ).
+enum class SortMethod { None, TopK, InMemory, External };
+const char* sort_method_name(SortMethod method);
+
+// ,     input_rows      entry_bytes.
+SortMethod predict_sort_method(size_t input_rows, size_t offset, size_t limit, size_t entry_bytes,
+    const SortOptions& options);
+
+// ,   ;     .
+using RowRefs = std::vector<const std::vector<Value>*>;
+
+//   rows   keys (   ) 
+//     rows   [offset, offset + limit). NULL 
+//   ,     .
+std::vector<size_t> sort_rows(const RowRefs& rows, const std::vector<std::pair<size_t, bool>>& keys,
+    size_t offset, size_t limit,
+    const SortOptions& options, SortMethod* method = nullptr);
+
+#endif // SORT_H
@@ -2,13 +2,97 @@
 #include <stdexcept>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
 #include <functional>
+#include <future>
 #include <iostream>
+#include <limits>
+#include <thread>
+#include "encoding.h"
+#include "query_context.h"
+#include "query_profile.h"
 #include "utils.h"
 
+//          .
+// TBL3   TBL2   (zone_map.h); TBL2 ,   .
+//  :    ,      TBL3.
+static const char TABLE_MAGIC[] = "TBL3";
+static const char TABLE_MAGIC_V2[] = "TBL2";
+static const char PARTITIONED_MAGIC[] = "TBP1";
+static const size_t BLOCK_ROWS = 4096;
+//    1/INDEX_REBUILD_FRACTION ,   ,
+//      .
+static const size_t INDEX_REBUILD_FRACTION = 4;
+
+//  ,   (8 )   .
+static void write_framed(std::ostream& os, const char* magic, const std::string& data) {
+    uint64_t size = data.size();
+    char size_bytes[8];
+    for (int i = 0; i < 8; ++i) {
+        size_bytes[i] = static_cast<char>((size >> (8 * i)) & 0xFF);
+    }
+    os.write(magic, 4);
+    os.write(size_bytes, sizeof(size_bytes));
+    os.write(data.data(), data.size());
+}
+
+//    ,  write_framed.
+static std::string read_framed(std::istream& is) {
+    char size_bytes[8];
+    if (!is.read(size_bytes, sizeof(size_bytes))) {
+        throw std::runtime_error("Invalid table header.");
+    }
+    uint64_t size = 0;
+    for (int i = 0; i < 8; ++i) {
+        size |= static_cast<uint64_t>(static_cast<unsigned char>(size_bytes[i])) << (8 * i);
+    }
+    std::string data(size, '\0');
+    if (!is.read(data.data(), size)) {
+        throw std::runtime_error("Unexpected end of file while reading table data.");
+    }
+    return data;
+}
+
+//  task(0) ... task(count - 1)    (   ).
+//     ,      .
+static void run_parallel(size_t count, const std::function<void(size_t)>& task) {
+    if (count <= 1) {
+        if (count == 1) {
+            task(0);
+        }
+        return;
+    }
+    const QueryContext* context = current_query_context;
+    size_t threads = std::min<size_t>(count, std::max(1u, std::thread::hardware_concurrency()));
+    std::atomic<size_t> next{ 0 };
+    std::vector<std::future<void>> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.push_back(std::async(std::launch::async, [&task, &next, count, context]() {
+            ScopedQueryContext scope(context);
+            for (size_t i = next++; i < count; i = next++) {
+                task(i);
+            }
+            }));
+    }
+    std::exception_ptr error;
+    for (auto& worker : workers) {
+        try {
+            worker.get();
+        }
+        catch (...) {
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
 
 //  
-Table::Table(const std::map<std::string, std::string>& schema) {
+Table::Table(const std::map<std::string, std::string>& schema, const PartitionScheme& partitioning) {
     for (const auto& [col_name, col_type] : schema) {
         std::string clean_col_name = trim(col_name);
         std::string clean_col_type = trim(col_type);
@@ -18,38 +102,74 @@ Table::Table(const std::map<std::string, std::string>& schema) {
         columns.push_back(clean_col_name);
         column_types[clean_col_name] = clean_col_type;
     }
+
+    validate_partitioning(partitioning, column_types);
+    this->partitioning = partitioning;
+    for (size_t i = 0; i < partition_count(partitioning); ++i) {
+        partitions.push_back(make_partition());
+    }
+}
+
+uint64_t Table::next_version() {
+    static std::atomic<uint64_t> counter{ 0 };
+    return ++counter;
+}
+
+std::shared_ptr<Table> Table::make_partition() const {
+    auto partition = std::make_shared<Table>();
+    partition->columns = columns;
+    partition->column_types = column_types;
+    partition->constraints = constraints;
+    partition->auto_index_policy = auto_index_policy;
+    partition->capture_changes = capture_changes;
+    return partition;
+}
+
+Table& Table::writable_partition(size_t index) {
+    //     :    
+    if (partitions[index].use_count() > 1) {
+        partitions[index] = partitions[index]->clone();
+    }
+    return *partitions[index];
+}
+
+std::vector<size_t> Table::partitions_for(const std::string& condition) const {
+    return prune_partitions(partitioning, parse_condition_tree(condition));
+}
+
+size_t Table::row_count() const {
+    size_t count = rows.size();
+    for (const auto& partition : partitions) {
+        count += partition->row_count();
+    }
+    return count;
 }
 
 //   is_unique
-bool Table::is_unique(const std::string& column_name, const std::any& value) const {
+bool Table::is_unique(const std::string& column_name, const Value& value) const {
     auto it = std::find(columns.begin(), columns.end(), column_name);
     if (it == columns.end()) {
         throw std::runtime_error("Column '" + column_name + "' not found.");
     }
 
+    if (is_partitioned()) {
+        //         
+        if (column_name == partitioning.column && value.has_value()) {
+            return partitions[partition_of(partitioning, value)]->is_unique(column_name, value);
+        }
+        for (const auto& partition : partitions) {
+            if (!partition->is_unique(column_name, value)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
     size_t column_index = std::distance(columns.begin(), it);
     for (const auto& row : rows) {
-        if (row[column_index].has_value()) {
-            if (row[column_index].type() == value.type()) {
-                if (row[column_index].type() == typeid(int)) {
-                    if (std::any_cast<int>(row[column_index]) == std::any_cast<int>(value)) {
-                        return false; //   
-                    }
-                }
-                else if (row[column_index].type() == typeid(std::string)) {
-                    if (std::any_cast<std::string>(row[column_index]) == std::any_cast<std::string>(value)) {
-                        return false; //   
-                    }
-                }
-                else if (row[column_index].type() == typeid(bool)) {
-                    if (std::any_cast<bool>(row[column_index]) == std::any_cast<bool>(value)) {
-                        return false; //   
-                    }
-                }
-                else {
-                    throw std::runtime_error("Unsupported type for uniqueness check.");
-                }
-            }
+        const Value& cell = row[column_index];
+        if (values_comparable(cell, value) && compare_values(cell, value) == 0) {
+            return false; //   
         }
     }
 
@@ -57,47 +177,215 @@ bool Table::is_unique(const std::string& column_name, const std::any& value) con
 }
 
 
-//  
+//  .
+// : ,   (8 ),     BLOCK_ROWS ,
+//       (. encoding.h),   ,
+//      ,  .
 void Table::save(std::ostream& os) const {
     if (columns.empty()) {
         throw std::runtime_error("Cannot save: no columns defined.");
     }
 
-    os << columns.size() << "\n";
+    ByteWriter out;
+    out.put_varint(columns.size());
     for (const auto& col : columns) {
-        os << col << " " << column_types.at(col) << "\n";
+        out.put_string(col);
+        out.put_string(column_types.at(col));
     }
 
-    os << rows.size() << "\n";
-    for (const auto& row : rows) {
-        for (size_t j = 0; j < row.size(); ++j) {
-            const auto& cell = row[j];
-            if (cell.has_value()) {
-                if (cell.type() == typeid(int)) {
-                    os << "int " << std::any_cast<int>(cell);
-                }
-                else if (cell.type() == typeid(std::string)) {
-                    os << "string " << std::any_cast<std::string>(cell);
-                }
-                else if (cell.type() == typeid(bool)) {
-                    os << "bool " << (std::any_cast<bool>(cell) ? "true" : "false");
-                }
-                else {
-                    os << "null";
+    if (is_partitioned()) {
+        out.put_byte(static_cast<uint8_t>(partitioning.kind));
+        out.put_string(partitioning.column);
+        out.put_varint(partitioning.hash_partitions);
+        out.put_varint(partitioning.range_bounds.size());
+        out.put_string(encode_column_block(partitioning.range_bounds));
+        out.put_varint(partitions.size());
+        save_view_links(out);
+        write_framed(os, PARTITIONED_MAGIC, out.data());
+        for (const auto& partition : partitions) {
+            partition->save(os);
+        }
+        return;
+    }
+
+    out.put_varint(rows.size());
+    out.put_varint(BLOCK_ROWS);
+    std::vector<Value> values;
+    for (size_t begin = 0; begin < rows.size(); begin += BLOCK_ROWS) {
+        size_t end = std::min(rows.size(), begin + BLOCK_ROWS);
+        for (size_t j = 0; j < columns.size(); ++j) {
+            values.clear();
+            for (size_t i = begin; i < end; ++i) {
+                values.push_back(rows[i][j]);
+            }
+            out.put_string(encode_column_block(values));
+        }
+    }
+    zones.save(out);
+    save_view_links(out);
+
+    write_framed(os, TABLE_MAGIC, out.data());
+}
+
+
+//  :     
+void Table::load(std::istream& is) {
+    while (is.peek() == '\n' || is.peek() == '\r') {
+        is.get();
+    }
+    if (is.peek() != TABLE_MAGIC[0]) {
+        load_text(is);
+        zones = ZoneMap();
+        zones.rebuild(rows);
+        analyze();
+        return;
+    }
+
+    char magic[sizeof(TABLE_MAGIC) - 1];
+    if (!is.read(magic, sizeof(magic))) {
+        throw std::runtime_error("Invalid table header.");
+    }
+    if (std::string(magic, sizeof(magic)) == PARTITIONED_MAGIC) {
+        load_partitioned(is);
+        return;
+    }
+    bool has_zones = std::string(magic, sizeof(magic)) == TABLE_MAGIC;
+    if (!has_zones && std::string(magic, sizeof(magic)) != TABLE_MAGIC_V2) {
+        throw std::runtime_error("Invalid table header.");
+    }
+    std::string data = read_framed(is);
+
+    ByteReader in(data);
+    size_t col_count = in.get_varint();
+    if (col_count == 0 || col_count > 1000) {
+        throw std::runtime_error("Column count out of valid range.");
+    }
+    columns.clear();
+    column_types.clear();
+    for (size_t i = 0; i < col_count; ++i) {
+        std::string col_name = in.get_string();
+        std::string col_type = in.get_string();
+        if (col_name.empty() || col_type.empty()) {
+            throw std::runtime_error("Column name or type is empty.");
+        }
+        columns.push_back(col_name);
+        column_types[col_name] = col_type;
+    }
+
+    size_t row_count = in.get_varint();
+    size_t block_rows = in.get_varint();
+    if (block_rows == 0 && row_count > 0) {
+        throw std::runtime_error("Invalid block size.");
+    }
+    rows.clear();
+    rows.resize(row_count, std::vector<Value>(columns.size()));
+    for (size_t begin = 0; begin < row_count; begin += block_rows) {
+        size_t count = std::min(row_count - begin, block_rows);
+        for (size_t j = 0; j < columns.size(); ++j) {
+            try {
+                auto values = decode_column_block(in.get_string(), count);
+                for (size_t i = 0; i < count; ++i) {
+                    rows.mutable_row(begin + i)[j] = std::move(values[i]);
                 }
             }
-            else {
-                os << "null";
+            catch (const std::exception& e) {
+                throw std::runtime_error("Error decoding column '" + columns[j] + "' at row " + std::to_string(begin) + ": " + e.what());
             }
-            if (j < row.size() - 1) os << " ";
         }
-        os << "\n";
     }
+
+    if (!has_zones || !zones.load(in, rows.size(), columns.size())) {
+        zones = ZoneMap();
+        zones.rebuild(rows);
+    }
+
+    indices.clear();
+    composite_indices.clear();
+    partitions.clear();
+    partitioning = PartitionScheme();
+    load_view_links(in);
+    analyze();
+}
+
+void Table::load_partitioned(std::istream& is) {
+    std::string data = read_framed(is);
+    ByteReader in(data);
+    size_t col_count = in.get_varint();
+    if (col_count == 0 || col_count > 1000) {
+        throw std::runtime_error("Column count out of valid range.");
+    }
+    columns.clear();
+    column_types.clear();
+    for (size_t i = 0; i < col_count; ++i) {
+        std::string col_name = in.get_string();
+        std::string col_type = in.get_string();
+        if (col_name.empty() || col_type.empty()) {
+            throw std::runtime_error("Column name or type is empty.");
+        }
+        columns.push_back(col_name);
+        column_types[col_name] = col_type;
+    }
+
+    PartitionScheme scheme;
+    uint8_t kind = in.get_byte();
+    if (kind != static_cast<uint8_t>(PartitionScheme::Kind::Hash) && kind != static_cast<uint8_t>(PartitionScheme::Kind::Range)) {
+        throw std::runtime_error("Unknown partitioning kind.");
+    }
+    scheme.kind = static_cast<PartitionScheme::Kind>(kind);
+    scheme.column = in.get_string();
+    scheme.hash_partitions = in.get_varint();
+    size_t bound_count = in.get_varint();
+    scheme.range_bounds = decode_column_block(in.get_string(), bound_count);
+    size_t partition_total = in.get_varint();
+    load_view_links(in);
+
+    validate_partitioning(scheme, column_types);
+    if (partition_total != partition_count(scheme)) {
+        throw std::runtime_error("Partition count does not match partitioning scheme.");
+    }
+
+    rows.clear();
+    indices.clear();
+    composite_indices.clear();
+    partitioning = scheme;
+    partitions.clear();
+    for (size_t i = 0; i < partition_total; ++i) {
+        partitions.push_back(make_partition());
+        partitions.back()->load(is);
+    }
+    set_change_capture(!dependent_views.empty());
+    analyze();
+}
+
+//    :      .
+void Table::save_view_links(ByteWriter& out) const {
+    if (dependent_views.empty() && view_query.empty()) {
+        return;
+    }
+    out.put_varint(dependent_views.size());
+    for (const auto& name : dependent_views) {
+        out.put_string(name);
+    }
+    out.put_string(view_query);
+}
+
+void Table::load_view_links(ByteReader& in) {
+    dependent_views.clear();
+    view_query.clear();
+    if (!in.at_end()) {
+        size_t count = in.get_varint();
+        for (size_t i = 0; i < count; ++i) {
+            dependent_views.insert(in.get_string());
+        }
+        view_query = in.get_string();
+    }
+    capture_changes = !dependent_views.empty();
+    changes = RowChanges();
 }
 
 
-//  
-void Table::load(std::istream& is) {
+//      
+void Table::load_text(std::istream& is) {
     std::string line;
 
     //   
@@ -152,9 +440,9 @@ void Table::load(std::istream& is) {
 
     //   
     rows.clear();
-    rows.resize(row_count);
+    rows.resize(row_count, std::vector<Value>(columns.size()));
     for (size_t i = 0; i < row_count; ++i) {
-        rows[i].resize(columns.size());
+        auto& row = rows.mutable_row(i);
         for (size_t j = 0; j < columns.size(); ++j) {
             std::string type, value;
             if (!(is >> type >> value)) {
@@ -164,22 +452,22 @@ void Table::load(std::istream& is) {
             value = trim(value);
             try {
                 if (type == "null") {
-                    rows[i][j] = std::any();
+                    row[j] = Value();
                 }
                 else if (type == "int") {
                     if (!is_numeric(value)) {
                         throw std::runtime_error("Invalid integer value: " + value);
                     }
-                    rows[i][j] = std::stoi(value);
+                    row[j] = std::stoi(value);
                 }
                 else if (type == "string") {
-                    rows[i][j] = value;
+                    row[j] = value;
                 }
                 else if (type == "bool") {
                     if (value != "true" && value != "false") {
                         throw std::runtime_error("Invalid boolean value: " + value);
                     }
-                    rows[i][j] = (value == "true");
+                    row[j] = (value == "true");
                 }
                 else {
                     throw std::runtime_error("Unknown type: " + type);
@@ -193,407 +481,1738 @@ void Table::load(std::istream& is) {
     }
 }
 
-std::vector<std::map<std::string, std::any>> Table::select(const std::string& condition) const {
-    std::vector<std::map<std::string, std::any>> result;
-    auto condition_fn = parse_condition(condition);
-
-    for (const auto& row : rows) {
-        std::map<std::string, std::any> mapped_row;
-        for (size_t i = 0; i < columns.size(); ++i) {
-            try {
-                if (row[i].type() == typeid(int)) {
-                    mapped_row[columns[i]] = std::any_cast<int>(row[i]);
-                }
-                else if (row[i].type() == typeid(std::string)) {
-                    mapped_row[columns[i]] = std::any_cast<std::string>(row[i]);
-                }
-                else if (row[i].type() == typeid(bool)) {
-                    mapped_row[columns[i]] = std::any_cast<bool>(row[i]);
-                }
-                else {
-                    mapped_row[columns[i]] = std::any(); // NULL value
-                }
-            }
-            catch (const std::exception& e) {
-                throw std::runtime_error("Error processing row value for column '" + columns[i] + "': " + e.what());
-            }
-        }
-        if (condition_fn(mapped_row)) {
-            result.push_back(mapped_row);
+std::vector<std::map<std::string, Value>> Table::select(const std::string& condition) const {
+    std::vector<std::map<std::string, Value>> result;
+    if (is_partitioned()) {
+        for (size_t index : partitions_for(condition)) {
+            auto part = partitions[index]->select(condition);
+            result.insert(result.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
         }
+        return result;
     }
-    return result;
-}
-
-
 
-void Table::update(const std::string& condition, const std::map<std::string, std::any>& updates) {
-    std::cout << "Updating rows with condition: " << condition << "\n";
-    auto condition_fn = parse_condition(condition);
-
-    for (auto& row : rows) {
-        std::map<std::string, std::any> mapped_row;
+    for (size_t pos : matching_rows(condition)) {
+        const auto& row = rows[pos];
+        std::map<std::string, Value> mapped_row;
         for (size_t i = 0; i < columns.size(); ++i) {
             mapped_row[columns[i]] = row[i];
         }
+        result.push_back(mapped_row);
+    }
+    return result;
+}
 
-        // ,     
-        if (condition_fn(mapped_row)) {
-            std::cout << "Row matches condition. Updating...\n";
-            for (const auto& [col_name, new_value] : updates) {
-                auto it = std::find(columns.begin(), columns.end(), col_name);
-                if (it == columns.end()) {
-                    throw std::runtime_error("Column '" + col_name + "' not found for update.");
-                }
-
-                size_t col_index = std::distance(columns.begin(), it);
-                const std::string& col_type = column_types[col_name];
-                std::cout << "Updating column '" << col_name << "' of type '" << col_type << "'\n";
+ResultBatch Table::select_batch(const std::string& condition, const std::vector<std::string>& projection,
+    const SelectOrder& order, const SortOptions& sort_options) const {
+    //     
+    for (const auto& name : projection) {
+        column_index(name);
+    }
+    std::vector<std::pair<size_t, bool>> keys;
+    for (const auto& key : order.keys) {
+        keys.emplace_back(column_index(key.column), key.descending);
+    }
+    //    :     ,   
+    std::vector<size_t> needed;
+    for (const auto& name : projection.empty() ? columns : projection) {
+        needed.push_back(column_index(name));
+    }
+    for (const auto& key : keys) {
+        needed.push_back(key.first);
+    }
 
-                try {
-                    if (!new_value.has_value()) {
-                        row[col_index] = std::any();
-                        std::cout << "Set column '" << col_name << "' to NULL.\n";
-                    }
-                    else if (col_type == "int32") {
-                        if (new_value.type() != typeid(int)) {
-                            throw std::runtime_error("Type mismatch: expected int32.");
-                        }
-                        row[col_index] = std::any_cast<int>(new_value);
-                        std::cout << "Updated column '" << col_name << "' to value: " << std::any_cast<int>(new_value) << "\n";
-                    }
-                    else if (col_type == "string") {
-                        if (new_value.type() != typeid(std::string)) {
-                            throw std::runtime_error("Type mismatch: expected string.");
-                        }
-                        row[col_index] = std::any_cast<std::string>(new_value);
-                        std::cout << "Updated column '" << col_name << "' to value: " << std::any_cast<std::string>(new_value) << "\n";
-                    }
-                    else if (col_type == "bool") {
-                        if (new_value.type() != typeid(bool)) {
-                            throw std::runtime_error("Type mismatch: expected bool.");
-                        }
-                        row[col_index] = std::any_cast<bool>(new_value);
-                        std::cout << "Updated column '" << col_name << "' to value: " << (std::any_cast<bool>(new_value) ? "true" : "false") << "\n";
-                    }
-                    else {
-                        throw std::runtime_error("Unsupported column type: " + col_type);
-                    }
-                }
-                catch (const std::exception& e) {
-                    throw std::runtime_error("Error updating column '" + col_name + "': " + e.what());
+    RowRefs matched;
+    if (is_partitioned()) {
+        std::vector<size_t> selected = partitions_for(condition);
+        ProfileScope scope("partitions", std::to_string(selected.size()) + " of " + std::to_string(partitions.size()));
+
+        //   ;  LIMIT    
+        // offset + limit  ,      
+        size_t window = (order.limit > std::numeric_limits<size_t>::max() - order.offset)
+            ? std::numeric_limits<size_t>::max() : order.offset + order.limit;
+        SortOptions partition_options = sort_options;
+        partition_options.memory_budget = std::max<size_t>(1, sort_options.memory_budget / std::max<size_t>(1, selected.size()));
+        std::vector<RowRefs> parts(selected.size());
+        run_parallel(selected.size(), [&](size_t i) {
+            const Table& partition = *partitions[selected[i]];
+            RowRefs refs = partition.matching_refs(condition, needed);
+            if (window < refs.size()) {
+                RowRefs top;
+                for (size_t r : sort_rows(refs, keys, 0, window, partition_options)) {
+                    top.push_back(refs[r]);
                 }
+                refs = std::move(top);
             }
+            parts[i] = std::move(refs);
+            });
+        for (auto& part : parts) {
+            matched.insert(matched.end(), part.begin(), part.end());
+        }
+        scope.set_rows(partitions.size(), matched.size());
+    }
+    else {
+        matched = matching_refs(condition, needed);
+    }
+    QueryMemoryCharge memory;
+    memory.set(vector_bytes(matched));
+    if (order.empty()) {
+        return make_batch(matched, projection);
+    }
+    //   ,    LIMIT/OFFSET
+    RowRefs window;
+    {
+        ProfileScope scope("sort");
+        SortMethod method = SortMethod::None;
+        for (size_t i : sort_rows(matched, keys, order.offset, order.limit, sort_options, &method)) {
+            window.push_back(matched[i]);
         }
+        scope.set_rows(matched.size(), window.size());
+        scope.set_detail(sort_method_name(method));
     }
+    return make_batch(window, projection);
 }
 
-
-void Table::remove(const std::string& condition) {
-    //  
-    auto condition_fn = parse_condition(condition);
-
-    // -   
-    auto match_condition = [&](const std::vector<std::any>& row) {
-        std::map<std::string, std::any> mapped_row;
-        for (size_t i = 0; i < columns.size(); ++i) {
-            mapped_row[columns[i]] = row[i];
-        }
-        try {
-            return condition_fn(mapped_row);
+ResultBatch Table::scan_batch(size_t first, size_t count, const std::vector<std::string>& projection) const {
+    //        
+    RowRefs selected;
+    auto collect = [&](const RowStore& source) {
+        if (first >= source.size()) {
+            first -= source.size();
+            return;
         }
-        catch (const std::exception& e) {
-            throw std::runtime_error("Error evaluating condition: " + std::string(e.what()));
+        for (size_t pos = first; pos < source.size() && selected.size() < count; ++pos) {
+            selected.push_back(&source[pos]);
         }
+        first = 0;
         };
-
-    //    
-    size_t initial_size = rows.size();
-
-    //  ,   
-    auto new_end = std::remove_if(rows.begin(), rows.end(), match_condition);
-    size_t removed_count = std::distance(new_end, rows.end());
-    rows.erase(new_end, rows.end());
-
-    //  
-    if (removed_count > 0) {
-        std::cout << "Removed " << removed_count << " row(s) matching condition: " << condition << "\n";
-    }
-    else {
-        std::cout << "No rows matched the condition: " << condition << "\n";
-    }
-
-    //   
-    if (rows.size() >= initial_size) {
-        std::cerr << "Warning: No rows were removed, check the condition syntax.\n";
+    collect(rows);
+    for (const auto& partition : partitions) {
+        collect(partition->rows);
     }
+    return make_batch(selected, projection);
 }
 
-
-
-void Table::create_index(const std::string& column) {
-    if (std::find(columns.begin(), columns.end(), column) == columns.end()) {
-        throw std::runtime_error("Column " + column + " not found.");
-    }
-    indices[column] = Index();
-    for (size_t i = 0; i < rows.size(); ++i) {
-        size_t col_index = std::distance(columns.begin(), std::find(columns.begin(), columns.end(), column));
-        indices[column].add_entry(rows[i][col_index], i);
+RowRefs Table::row_refs(const std::vector<size_t>& positions) const {
+    RowRefs refs;
+    refs.reserve(positions.size());
+    for (size_t pos : positions) {
+        refs.push_back(&rows[pos]);
     }
+    return refs;
 }
 
-void Table::auto_index(const std::string& column) {
-    if (indices.find(column) == indices.end()) {
-        create_index(column);
-        std::cout << "Auto index created for column: " << column << std::endl;
+ResultBatch Table::make_batch(const RowRefs& matched, const std::vector<std::string>& projection) const {
+    ProfileScope scope("materialize");
+    scope.set_rows(matched.size(), matched.size());
+    const std::vector<std::string>& names = projection.empty() ? columns : projection;
+    std::vector<size_t> ordinals;
+    for (const auto& name : names) {
+        ordinals.push_back(column_index(name));
     }
-}
-
-void Table::insert(const std::map<std::string, std::any>& values) {
-    std::vector<std::any> row(columns.size());
-    for (size_t i = 0; i < columns.size(); ++i) {
-        const auto& col_name = columns[i];
-        if (values.find(col_name) != values.end() && values.at(col_name).has_value()) {
-            std::cout << "Inserting value for column: " << col_name << ", Value type: "
-                << values.at(col_name).type().name() << std::endl;
 
-            if (constraints[col_name] == "NOT NULL" && !values.at(col_name).has_value()) {
-                throw std::runtime_error("Column '" + col_name + "' cannot be NULL.");
+    ResultBatch batch;
+    batch.row_count = matched.size();
+    size_t bitmap_bytes = (matched.size() + 7) / 8;
+    //      ,  -   
+    QueryMemoryCharge memory;
+    size_t batch_bytes = 0;
+
+    //     ,      
+    for (size_t c = 0; c < names.size(); ++c) {
+        size_t col = ordinals[c];
+        ColumnBatch column;
+        column.name = names[c];
+        column.type = column_types.at(names[c]);
+        column.validity.assign(bitmap_bytes, 0);
+
+        if (column.type == "int32") {
+            column.int_values.assign(matched.size(), 0);
+            for (size_t i = 0; i < matched.size(); ++i) {
+                const Value& value = (*matched[i])[col];
+                if (value.is_int()) {
+                    column.int_values[i] = value.as_int();
+                    column.validity[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+                }
+            }
+        }
+        else if (column.type == "bool") {
+            column.bool_values.assign(bitmap_bytes, 0);
+            for (size_t i = 0; i < matched.size(); ++i) {
+                const Value& value = (*matched[i])[col];
+                if (value.is_bool()) {
+                    if (value.as_bool()) {
+                        column.bool_values[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+                    }
+                    column.validity[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+                }
+            }
+        }
+        else if (column.type == "string") {
+            column.offsets.reserve(matched.size() + 1);
+            column.offsets.push_back(0);
+            for (size_t i = 0; i < matched.size(); ++i) {
+                if ((i & 1023) == 0) {
+                    check_query_interrupted();
+                    memory.set(batch_bytes + column.memory_bytes());
+                }
+                const Value& value = (*matched[i])[col];
+                if (value.is_string()) {
+                    column.string_data += value.as_string();
+                    column.validity[i / 8] |= static_cast<uint8_t>(1u << (i % 8));
+                }
+                if (column.string_data.size() > static_cast<size_t>(std::numeric_limits<int32_t>::max())) {
+                    throw std::runtime_error("Result column '" + column.name + "' exceeds 2 GB of string data.");
+                }
+                column.offsets.push_back(static_cast<int32_t>(column.string_data.size()));
             }
-            row[i] = values.at(col_name);
         }
         else {
-            std::cout << "Inserting default (NULL) value for column: " << col_name << std::endl;
-            if (constraints[col_name] == "NOT NULL") {
-                throw std::runtime_error("Column '" + col_name + "' cannot be NULL.");
+            throw std::runtime_error("Unsupported column type: " + column.type);
+        }
+
+        for (size_t i = 0; i < matched.size(); ++i) {
+            if (!column.is_valid(i)) {
+                ++column.null_count;
             }
-            row[i] = std::any();
         }
+        batch_bytes += column.memory_bytes();
+        memory.set(batch_bytes);
+        batch.columns.push_back(std::move(column));
     }
-    rows.push_back(row);
-}
-
-
-std::shared_ptr<Table> Table::clone() const {
-    auto new_table = std::make_shared<Table>();
-    new_table->columns = this->columns;
-    new_table->column_types = this->column_types;
-    new_table->rows = this->rows;
-    new_table->indices = this->indices;
-    new_table->constraints = this->constraints;
-    return new_table;
+    return batch;
 }
 
 
 
-
-std::function<bool(const std::map<std::string, std::any>&)> Table::parse_condition(const std::string& condition) const {
-    std::cout << "Parsing condition: " << condition << "\n";
-    std::string trimmed_condition = trim(condition);
-
-    //  "true"  "false" ,    /
-    if (trimmed_condition == "true") {
-        return [](const std::map<std::string, std::any>&) { return true; };
-    }
-    if (trimmed_condition == "false") {
-        return [](const std::map<std::string, std::any>&) { return false; };
+size_t Table::update(const std::string& condition, const std::map<std::string, Value>& updates) {
+    std::vector<Assignment> assignments;
+    for (const auto& [col_name, new_value] : updates) {
+        assignments.push_back({ col_name, Expression::literal(new_value) });
     }
+    return update(condition, assignments);
+}
 
-    //    AND  OR
-    if (trimmed_condition.find(" AND ") != std::string::npos) {
-        size_t pos = trimmed_condition.find(" AND ");
-        std::string left = trimmed_condition.substr(0, pos);
-        std::string right = trimmed_condition.substr(pos + 5);
-        return [this, left, right](const std::map<std::string, std::any>& row) {
-            return parse_condition(left)(row) && parse_condition(right)(row);
-            };
-    }
-    if (trimmed_condition.find(" OR ") != std::string::npos) {
-        size_t pos = trimmed_condition.find(" OR ");
-        std::string left = trimmed_condition.substr(0, pos);
-        std::string right = trimmed_condition.substr(pos + 4);
-        return [this, left, right](const std::map<std::string, std::any>& row) {
-            return parse_condition(left)(row) || parse_condition(right)(row);
-            };
-    }
+size_t Table::update(const std::string& condition, const std::vector<Assignment>& assignments) {
+    std::set<std::string> assigned;
+    std::vector<UpdateStep> steps = compile_assignments(assignments, assigned);
 
-    //  NOT
-    if (trimmed_condition.find("NOT ") == 0) {
-        std::string inner = trimmed_condition.substr(4);
-        return [this, inner](const std::map<std::string, std::any>& row) {
-            return !parse_condition(inner)(row);
-            };
+    size_t updated = 0;
+    if (is_partitioned()) {
+        updated = update_partitions(condition, steps, assigned);
+    }
+    else {
+        auto matched = matching_rows(condition);
+        ProfileScope scope("update", std::to_string(steps.size()) + " assignment(s)");
+        scope.set_rows(matched.size(), matched.size());
+        apply_update(matched, evaluate_update(matched, steps), steps, assigned);
+        updated = matched.size();
     }
 
-    //   (, "name='Alice'")
-    return parse_simple_condition(trimmed_condition);
+    std::cout << "Updated " << updated << " row(s) matching condition: " << condition << "\n";
+    return updated;
 }
 
+//    :          .
+//       ,     .
+std::vector<Table::UpdateStep> Table::compile_assignments(const std::vector<Assignment>& assignments,
+    std::set<std::string>& assigned) const {
+    std::vector<UpdateStep> steps;
+    for (const auto& assignment : assignments) {
+        if (!assigned.insert(assignment.column).second) {
+            throw std::runtime_error("Column '" + assignment.column + "' is assigned more than once.");
+        }
+        auto it = column_types.find(assignment.column);
+        if (it == column_types.end()) {
+            throw std::runtime_error("Column '" + assignment.column + "' not found for update.");
+        }
+        const std::string& col_type = it->second;
+        if (col_type != "int32" && col_type != "string" && col_type != "bool") {
+            throw std::runtime_error("Unsupported column type: " + col_type);
+        }
 
-
-
-std::function<bool(const std::map<std::string, std::any>&)> Table::parse_condition(const std::string& condition) const {
-    std::cout << "Parsing condition: " << condition << "\n";
-    std::string trimmed_condition = trim(condition);
-
-    if (trimmed_condition == "true") {
-        return [](const std::map<std::string, std::any>&) { return true; };
-    }
-    if (trimmed_condition == "false") {
-        return [](const std::map<std::string, std::any>&) { return false; };
+        std::string result_type;
+        RowExpression value;
+        try {
+            value = compile_expression(assignment.value, result_type);
+        }
+        catch (const std::exception& e) {
+            throw std::runtime_error("Error updating column '" + assignment.column + "': " + e.what());
+        }
+        if (!result_type.empty() && result_type != col_type) {
+            throw std::runtime_error("Error updating column '" + assignment.column + "': Type mismatch: expected " + col_type + ".");
+        }
+        steps.push_back({ column_index(assignment.column), std::move(value) });
     }
+    return steps;
+}
 
-    if (trimmed_condition.find(" AND ") != std::string::npos) {
-        size_t pos = trimmed_condition.find(" AND ");
-        std::string left = trimmed_condition.substr(0, pos);
-        std::string right = trimmed_condition.substr(pos + 5);
-        return [this, left, right](const std::map<std::string, std::any>& row) {
-            return parse_condition(left)(row) && parse_condition(right)(row);
-            };
+std::vector<Value> Table::evaluate_update(const std::vector<size_t>& matched, const std::vector<UpdateStep>& steps) const {
+    //    ,    (,   )
+    //   ,      
+    std::vector<Value> values;
+    values.reserve(matched.size() * steps.size());
+    for (size_t pos : matched) {
+        for (const auto& step : steps) {
+            values.push_back(step.value(rows[pos]));
+        }
     }
+    return values;
+}
 
-    if (trimmed_condition.find(" OR ") != std::string::npos) {
-        size_t pos = trimmed_condition.find(" OR ");
-        std::string left = trimmed_condition.substr(0, pos);
-        std::string right = trimmed_condition.substr(pos + 4);
-        return [this, left, right](const std::map<std::string, std::any>& row) {
-            return parse_condition(left)(row) || parse_condition(right)(row);
-            };
+void Table::apply_update(const std::vector<size_t>& matched, std::vector<Value> values,
+    const std::vector<UpdateStep>& steps, const std::set<std::string>& assigned) {
+    //    :        
+    std::vector<std::pair<size_t, Index*>> changed_indices;
+    for (const auto& step : steps) {
+        auto it = indices.find(columns[step.column]);
+        if (it != indices.end()) {
+            changed_indices.emplace_back(step.column, &it->second);
+        }
     }
-
-    size_t equals_pos = trimmed_condition.find('=');
-    if (equals_pos == std::string::npos) {
-        throw std::runtime_error("Syntax error in condition: " + condition);
+    std::vector<CompositeIndex*> changed_composites;
+    for (auto& [name, index] : composite_indices) {
+        if (std::any_of(assigned.begin(), assigned.end(), [&](const std::string& column) { return index.covers(column_index(column)); })) {
+            changed_composites.push_back(&index);
+        }
     }
+    bool rebuild = matched.size() * INDEX_REBUILD_FRACTION > rows.size();
 
-    std::string col_name = trim(trimmed_condition.substr(0, equals_pos));
-    std::string col_value = trim(trimmed_condition.substr(equals_pos + 1));
-
-    if (col_value.empty()) {
-        throw std::runtime_error("Empty value in condition: " + condition);
-    }
-    col_value.erase(col_value.find_last_not_of(" \t") + 1);
-    if (col_value == "true" || col_value == "false") {
-        bool bool_value = (col_value == "true");
-        return [col_name, bool_value](const std::map<std::string, std::any>& row) {
-            auto it = row.find(col_name);
-            if (it == row.end()) {
-                throw std::runtime_error("Column '" + col_name + "' not found.");
+    size_t next = 0;
+    for (size_t pos : matched) {
+        if (capture_changes) {
+            changes.deleted.push_back(rows[pos]);
+        }
+        if (!rebuild) {
+            for (auto& [column, index] : changed_indices) {
+                index->remove_entry(rows[pos][column], pos);
             }
-            if (it->second.type() != typeid(bool)) {
-                throw std::runtime_error("Type mismatch for column '" + col_name + "', expected bool.");
+            for (CompositeIndex* index : changed_composites) {
+                index->remove_entry(rows[pos], pos);
             }
-            return std::any_cast<bool>(it->second) == bool_value;
-            return !row.at(col_name).has_value();
-            return !row.at(col_name).has_value();
+        }
+        for (const auto& step : steps) {
+            zones.widen(pos, step.column, values[next]);
+            rows.mutable_row(pos)[step.column] = std::move(values[next++]);
+        }
+        if (!rebuild) {
+            for (auto& [column, index] : changed_indices) {
+                // NULL    
+                if (rows[pos][column].has_value()) {
+                    index->add_entry(rows[pos][column], pos);
+                }
+            }
+            for (CompositeIndex* index : changed_composites) {
+                index->add_entry(rows[pos], pos);
+            }
+        }
+        if (capture_changes) {
+            changes.inserted.push_back(rows[pos]);
+        }
+    }
+
+    if (rebuild && !matched.empty()) {
+        for (auto& [column, index] : changed_indices) {
+            rebuild_index(columns[column]);
+        }
+        for (CompositeIndex* index : changed_composites) {
+            rebuild_composite_index(*index);
+        }
+    }
+    note_modification(matched.size());
+}
 
-    if (col_value[0] == '\'' && col_value.back() == '\'') {
-        std::string str_value = col_value.substr(1, col_value.size() - 2);
-        return [col_name, str_value](const std::map<std::string, std::any>& row) {
-            auto it = row.find(col_name);
-            if (it == row.end()) {
-                throw std::runtime_error("Column '" + col_name + "' not found.");
+size_t Table::update_partitions(const std::string& condition, const std::vector<UpdateStep>& steps,
+    const std::set<std::string>& assigned) {
+    std::vector<size_t> selected = partitions_for(condition);
+    ProfileScope scope("update", std::to_string(steps.size()) + " assignment(s), " +
+        std::to_string(selected.size()) + " of " + std::to_string(partitions.size()) + " partitions");
+
+    //         ,   
+    //  :        
+    std::vector<std::vector<size_t>> matched(selected.size());
+    std::vector<std::vector<Value>> values(selected.size());
+    run_parallel(selected.size(), [&](size_t i) {
+        const Table& partition = *partitions[selected[i]];
+        matched[i] = partition.matching_rows(condition);
+        values[i] = partition.evaluate_update(matched[i], steps);
+        });
+
+    std::vector<size_t> touched;
+    size_t updated = 0;
+    for (size_t i = 0; i < selected.size(); ++i) {
+        if (!matched[i].empty()) {
+            writable_partition(selected[i]);
+            touched.push_back(i);
+            updated += matched[i].size();
+        }
+    }
+    run_parallel(touched.size(), [&](size_t t) {
+        size_t i = touched[t];
+        partitions[selected[i]]->apply_update(matched[i], std::move(values[i]), steps, assigned);
+        });
+    scope.set_rows(updated, updated);
+
+    //         
+    if (!assigned.count(partitioning.column)) {
+        return updated;
+    }
+    size_t key = column_index(partitioning.column);
+    std::vector<std::vector<std::vector<Value>>> moved(partitions.size());
+    for (size_t i : touched) {
+        Table& partition = *partitions[selected[i]];
+        std::vector<size_t> leaving;
+        for (size_t pos : matched[i]) {
+            size_t target = partition_of(partitioning, partition.rows[pos][key]);
+            if (target != selected[i]) {
+                moved[target].push_back(partition.rows[pos]);
+                leaving.push_back(pos);
             }
-            if (it->second.type() != typeid(std::string)) {
-                throw std::runtime_error("Type mismatch for column '" + col_name + "', expected string.");
+        }
+        if (!leaving.empty()) {
+            partition.erase_rows(leaving);
+        }
+    }
+    for (size_t target = 0; target < partitions.size(); ++target) {
+        if (!moved[target].empty()) {
+            writable_partition(target).append_batch(std::move(moved[target]));
+        }
+    }
+    return updated;
+}
+
+size_t Table::remove(const std::string& condition) {
+    size_t removed_count = 0;
+    if (is_partitioned()) {
+        std::vector<size_t> selected = partitions_for(condition);
+
+        //     ,      
+        std::vector<std::vector<size_t>> matched(selected.size());
+        run_parallel(selected.size(), [&](size_t i) {
+            matched[i] = partitions[selected[i]]->matching_rows(condition);
+            });
+        std::vector<size_t> touched;
+        for (size_t i = 0; i < selected.size(); ++i) {
+            if (!matched[i].empty()) {
+                writable_partition(selected[i]);
+                touched.push_back(i);
             }
-            return std::any_cast<std::string>(it->second) == str_value;
-            };
+        }
+        std::vector<size_t> removed(touched.size());
+        run_parallel(touched.size(), [&](size_t t) {
+            removed[t] = partitions[selected[touched[t]]]->erase_rows(matched[touched[t]]);
+            });
+        for (size_t count : removed) {
+            removed_count += count;
+        }
     }
+    else {
+        removed_count = erase_rows(matching_rows(condition));
+    }
+
+    //  
+    if (removed_count > 0) {
+        std::cout << "Removed " << removed_count << " row(s) matching condition: " << condition << "\n";
+    }
+    else {
+        std::cout << "No rows matched the condition: " << condition << "\n";
+        std::cerr << "Warning: No rows were removed, check the condition syntax.\n";
+    }
+    return removed_count;
+}
 
-    if (is_numeric(col_value)) {
-        int int_value = std::stoi(col_value);
-        return [col_name, int_value](const std::map<std::string, std::any>& row) {
-            auto it = row.find(col_name);
-            if (it == row.end()) {
-                throw std::runtime_error("Column '" + col_name + "' not found.");
+size_t Table::erase_rows(const std::vector<size_t>& positions) {
+    //  ,   
+    std::vector<bool> removed(rows.size(), false);
+    size_t first_removed = rows.size();
+    for (size_t pos : positions) {
+        removed[pos] = true;
+        first_removed = std::min(first_removed, pos);
+    }
+    ProfileScope scope("delete");
+
+    // :       . ,   
+    //    ,       ,
+    //      ;   -   
+    //      
+    size_t old_size = rows.size();
+    bool rebuild = positions.size() * INDEX_REBUILD_FRACTION > old_size;
+    bool by_row = !rebuild && (old_size - first_removed) * INDEX_REBUILD_FRACTION <= old_size;
+    std::vector<size_t> ordinals;
+    for (const auto& [column, index] : indices) {
+        ordinals.push_back(column_index(column));
+    }
+    if (by_row) {
+        for (size_t pos : positions) {
+            size_t i = 0;
+            for (auto& [column, index] : indices) {
+                index.remove_entry(rows[pos][ordinals[i++]], pos);
             }
-            if (it->second.type() != typeid(int)) {
-                throw std::runtime_error("Type mismatch for column '" + col_name + "', expected int.");
+            for (auto& [name, index] : composite_indices) {
+                index.remove_entry(rows[pos], pos);
             }
-            return std::any_cast<int>(it->second) == int_value;
-            return row.at(col_name).type() == typeid(int) && std::any_cast<int>(row.at(col_name)) == int_value;
-            return row.at(col_name).type() == typeid(int) && std::any_cast<int>(row.at(col_name)) == int_value;
+        }
+    }
+
+    //   
+    std::vector<size_t> erased;
+    size_t write = 0;
+    for (size_t read = 0; read < rows.size(); ++read) {
+        if (!removed[read]) {
+            if (write != read) {
+                rows.mutable_row(write) = std::move(rows.mutable_row(read));
+            }
+            ++write;
+        }
+        else {
+            erased.push_back(read);
+            if (capture_changes) {
+                changes.deleted.push_back(rows[read]);
+            }
+        }
+    }
+    size_t removed_count = rows.size() - write;
+    scope.set_rows(rows.size(), removed_count);
+    rows.resize(write);
+
+    //   ;       
+    if (removed_count > 0) {
+        if (rebuild) {
+            rebuild_indices();
+        }
+        else if (by_row) {
+            size_t shift = 0;
+            for (size_t pos = first_removed; pos < rows.size(); ++pos) {
+                while (shift < erased.size() && erased[shift] <= pos + shift) {
+                    ++shift;
+                }
+                size_t i = 0;
+                for (auto& [column, index] : indices) {
+                    index.move_entry(rows[pos][ordinals[i++]], pos + shift, pos);
+                }
+                for (auto& [name, index] : composite_indices) {
+                    index.move_entry(rows[pos], pos + shift, pos);
+                }
+            }
+        }
+        else {
+            for (auto& [column, index] : indices) {
+                index.erase_rows(erased);
+            }
+            for (auto& [name, index] : composite_indices) {
+                index.erase_rows(erased);
+            }
+        }
+        zones.rebuild(rows, first_removed);
+    }
+    note_modification(removed_count);
+    return removed_count;
+}
+
+
+
+size_t Table::column_index(const std::string& column) const {
+    auto it = std::find(columns.begin(), columns.end(), column);
+    if (it == columns.end()) {
+        throw std::runtime_error("Column " + column + " not found.");
+    }
+    return std::distance(columns.begin(), it);
+}
+
+void Table::create_index(const std::string& column, IndexKind kind) {
+    column_index(column);
+    const std::string& col_type = column_types.at(column);
+    bool bool_bitmap = (kind == IndexKind::Bitmap && col_type == "bool");
+    if (col_type != "int32" && col_type != "string" && !bool_bitmap) {
+        throw std::runtime_error("Index on column " + column + " of type '" + col_type + "' is not supported.");
+    }
+    if (kind == IndexKind::Text && col_type != "string") {
+        throw std::runtime_error("Text index on column " + column + " requires a string column.");
+    }
+    if (is_partitioned()) {
+        //     ;   
+        for (size_t i = 0; i < partitions.size(); ++i) {
+            writable_partition(i);
+        }
+        run_parallel(partitions.size(), [&](size_t i) {
+            partitions[i]->create_index(column, kind);
+            });
+        return;
+    }
+    auto_indexed_columns.erase(column);
+    indices[column] = Index(kind);
+    rebuild_index(column);
+}
+
+void Table::rebuild_index(const std::string& column) {
+    size_t col_index = column_index(column);
+    auto existing = indices.find(column);
+    Index index(existing != indices.end() ? existing->second.kind() : IndexKind::Hash);
+    for (size_t i = 0; i < rows.size(); ++i) {
+        // NULL    :      
+        if (rows[i][col_index].has_value()) {
+            index.add_entry(rows[i][col_index], i);
+        }
+    }
+    indices[column] = std::move(index);
+}
+
+void Table::rebuild_indices() {
+    for (auto& [column, index] : indices) {
+        rebuild_index(column);
+    }
+    for (auto& [name, index] : composite_indices) {
+        rebuild_composite_index(index);
+    }
+}
+
+void Table::rebuild_composite_index(CompositeIndex& index) {
+    index.clear();
+    for (size_t i = 0; i < rows.size(); ++i) {
+        index.add_entry(rows[i], i);
+    }
+}
+
+std::string Table::create_composite_index(const std::vector<std::string>& key_columns,
+    const std::vector<std::string>& included_columns) {
+    if (key_columns.empty()) {
+        throw std::runtime_error("Index needs at least one key column.");
+    }
+    std::set<std::string> seen;
+    std::vector<size_t> key_ordinals, included_ordinals;
+    std::string name;
+    for (const auto& column : key_columns) {
+        key_ordinals.push_back(column_index(column));
+        const std::string& col_type = column_types.at(column);
+        if (col_type != "int32" && col_type != "string" && col_type != "bool") {
+            throw std::runtime_error("Index on column " + column + " of type '" + col_type + "' is not supported.");
+        }
+        if (!seen.insert(column).second) {
+            throw std::runtime_error("Column " + column + " is listed twice in index.");
+        }
+        name += (name.empty() ? "" : ",") + column;
+    }
+    for (const auto& column : included_columns) {
+        included_ordinals.push_back(column_index(column));
+        if (!seen.insert(column).second) {
+            throw std::runtime_error("Column " + column + " is listed twice in index.");
+        }
+    }
+
+    if (is_partitioned()) {
+        for (size_t i = 0; i < partitions.size(); ++i) {
+            writable_partition(i);
+        }
+        run_parallel(partitions.size(), [&](size_t i) {
+            partitions[i]->create_composite_index(key_columns, included_columns);
+            });
+        return name;
+    }
+    CompositeIndex index(std::move(key_ordinals), std::move(included_ordinals), columns.size());
+    rebuild_composite_index(index);
+    composite_indices[name] = std::move(index);
+    return name;
+}
+
+bool Table::has_composite_index(const std::vector<std::string>& key_columns) const {
+    std::string name;
+    for (const auto& column : key_columns) {
+        name += (name.empty() ? "" : ",") + column;
+    }
+    if (is_partitioned()) {
+        return partitions.front()->has_composite_index(key_columns);
+    }
+    return composite_indices.count(name) > 0;
+}
+
+void Table::auto_index(const std::string& column) {
+    if (indices.find(column) == indices.end()) {
+        create_index(column);
+        auto_indexed_columns.insert(column);
+        std::cout << "Auto index created for column: " << column << std::endl;
+    }
+}
 
-    throw std::runtime_error("Unsupported value format in condition: " + condition);
+void Table::set_auto_index_policy(const AutoIndexPolicy& policy) {
+    auto_index_policy = policy;
+    for (size_t i = 0; i < partitions.size(); ++i) {
+        writable_partition(i).set_auto_index_policy(policy);
+    }
 }
+
+const AutoIndexPolicy& Table::get_auto_index_policy() const {
+    return auto_index_policy;
 }
 
-std::function<bool(const std::map<std::string, std::any>&)> Table::parse_simple_condition(const std::string& condition) const {
-    auto equals_pos = condition.find('=');
-    if (equals_pos == std::string::npos) {
-        throw std::runtime_error("Syntax error in condition: " + condition);
+void Table::apply_auto_indexing() {
+    //         
+    for (auto& partition : partitions) {
+        partition->apply_auto_indexing();
+    }
+    if (!auto_index_policy.enabled || is_partitioned()) {
+        return;
     }
+    std::unique_lock<std::shared_mutex> index_lock(index_mutex);
+    std::lock_guard<std::mutex> usage_lock(usage_mutex);
+
+    //           ,
+    //   ,       .
+    double build_cost = auto_index_policy.build_cost_factor * static_cast<double>(rows.size());
+    for (auto& [column, usage] : column_usage) {
+        if (indices.find(column) != indices.end()) {
+            continue;
+        }
+        const std::string& col_type = column_types.at(column);
+        if (col_type != "int32" && col_type != "string") {
+            continue;
+        }
+        if (usage.equality_hits < auto_index_policy.min_equality_hits ||
+            static_cast<double>(usage.pending_savings) <= build_cost) {
+            continue;
+        }
+
+        auto_index(column);
+        usage.last_index_use = query_counter;
+        index_decisions.push_back("created auto index on " + column + ": " +
+            std::to_string(usage.pending_savings) + " rows of scanning saved vs build cost " +
+            std::to_string(static_cast<size_t>(build_cost)));
+        usage.pending_savings = 0;
     }
-    std::string col_name = trim(condition.substr(0, equals_pos));
-    std::string col_value = trim(condition.substr(equals_pos + 1));
 
-    if (col_name.empty()) {
-        throw std::runtime_error("Column name is empty in condition: " + condition);
+    if (!auto_index_policy.drop_unused) {
+        return;
     }
+    for (auto it = auto_indexed_columns.begin(); it != auto_indexed_columns.end();) {
+        ColumnUsage& usage = column_usage[*it];
+        size_t idle = query_counter - usage.last_index_use;
+        if (idle < auto_index_policy.unused_after_queries) {
+            ++it;
+            continue;
+        }
+        indices.erase(*it);
+        index_decisions.push_back("dropped auto index on " + *it + ": unused for " +
+            std::to_string(idle) + " queries");
+        std::cout << "Auto index dropped for column: " << *it << std::endl;
+        it = auto_indexed_columns.erase(it);
+    }
+}
 
-    //   NULL
-    if (col_value.empty() || col_value == "NULL" || col_value == "null") {
-        return [col_name](const std::map<std::string, std::any>& row) {
-            auto it = row.find(col_name);
-            if (it == row.end()) {
-                throw std::runtime_error("Column '" + col_name + "' not found.");
+std::string Table::describe_indices() const {
+    if (is_partitioned()) {
+        std::ostringstream out;
+        for (size_t i = 0; i < partitions.size(); ++i) {
+            out << "partition " << i << ":\n" << partitions[i]->describe_indices();
+        }
+        return out.str();
+    }
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex);
+    std::lock_guard<std::mutex> usage_lock(usage_mutex);
+    std::ostringstream out;
+    for (const auto& column : columns) {
+        auto usage_it = column_usage.find(column);
+        bool indexed = indices.find(column) != indices.end();
+        if (!indexed && usage_it == column_usage.end()) {
+            continue;
+        }
+        out << "column: " << column << ", index: ";
+        if (!indexed) {
+            out << "none";
+        }
+        else {
+            out << (auto_indexed_columns.count(column) ? "auto" : "manual");
+            if (indices.at(column).kind() == IndexKind::Text) {
+                out << " (text)";
             }
-            return !it->second.has_value();
-            };
+            else if (indices.at(column).kind() == IndexKind::Bitmap) {
+                out << " (bitmap)";
+            }
+        }
+        if (usage_it != column_usage.end()) {
+            const ColumnUsage& usage = usage_it->second;
+            out << ", equality predicates: " << usage.equality_hits
+                << ", range predicates: " << usage.range_hits
+                << ", rows evaluated: " << usage.rows_evaluated
+                << ", rows matched: " << usage.rows_matched
+                << ", index lookups: " << usage.index_lookups
+                << ", pending savings: " << usage.pending_savings;
+        }
+        out << "\n";
+    }
+    for (const auto& [name, index] : composite_indices) {
+        out << "index: " << name;
+        if (!index.included_columns().empty()) {
+            out << " include ";
+            for (size_t i = 0; i < index.included_columns().size(); ++i) {
+                out << (i > 0 ? "," : "") << columns[index.included_columns()[i]];
+            }
+        }
+        out << " (composite)\n";
     }
+    for (const auto& decision : index_decisions) {
+        out << "decision: " << decision << "\n";
+    }
+    return out.str();
+}
 
-    //   
-    if (!col_value.empty() && col_value[0] == '\'' && col_value.back() == '\'') {
-        col_value = col_value.substr(1, col_value.size() - 2); //  
-        return [col_name, col_value](const std::map<std::string, std::any>& row) {
-            auto it = row.find(col_name);
-            if (it == row.end() || it->second.type() != typeid(std::string)) {
-                return false;
+void Table::insert(const std::map<std::string, Value>& values) {
+    if (is_partitioned()) {
+        auto key = values.find(partitioning.column);
+        if (key == values.end() || !key->second.has_value()) {
+            writable_partition(0).insert(values);
+            return;
+        }
+        if (key->second.type() != column_value_type(column_types.at(partitioning.column))) {
+            throw std::runtime_error("Type mismatch for partition column '" + partitioning.column + "': expected " +
+                column_types.at(partitioning.column) + ".");
+        }
+        writable_partition(partition_of(partitioning, key->second)).insert(values);
+        return;
+    }
+
+    std::vector<Value> row(columns.size());
+    for (size_t i = 0; i < columns.size(); ++i) {
+        const auto& col_name = columns[i];
+        if (values.find(col_name) != values.end() && values.at(col_name).has_value()) {
+            //    ,    check_batch
+            const std::string& col_type = column_types.at(col_name);
+            if (values.at(col_name).type() != column_value_type(col_type)) {
+                throw std::runtime_error("Type mismatch for column '" + col_name + "': expected " + col_type + ".");
             }
-            return std::any_cast<std::string>(it->second) == col_value;
-            };
+            row[i] = values.at(col_name);
+        }
+        else {
+            if (constraints[col_name] == "NOT NULL") {
+                throw std::runtime_error("Column '" + col_name + "' cannot be NULL.");
+            }
+            row[i] = Value();
+        }
+    }
+    if (capture_changes) {
+        changes.inserted.push_back(row);
     }
+    rows.push_back(row);
+    zones.append(rows, rows.size() - 1);
 
-    //   
-    if (col_value == "true" || col_value == "false") {
-        bool bool_value = (col_value == "true");
-        return [col_name, bool_value](const std::map<std::string, std::any>& row) {
-            auto it = row.find(col_name);
-            if (it == row.end() || it->second.type() != typeid(bool)) {
-                return false;
+    for (auto& [column, index] : indices) {
+        const auto& cell = rows.back()[column_index(column)];
+        if (cell.has_value()) {
+            index.add_entry(cell, rows.size() - 1);
+        }
+    }
+    for (auto& [name, index] : composite_indices) {
+        index.add_entry(rows.back(), rows.size() - 1);
+    }
+    note_modification(1);
+}
+
+void Table::insert_batch(std::vector<std::vector<Value>> batch) {
+    //     :     
+    check_batch(batch);
+    if (!is_partitioned()) {
+        append_batch(std::move(batch));
+        return;
+    }
+
+    size_t key = column_index(partitioning.column);
+    std::vector<std::vector<std::vector<Value>>> groups(partitions.size());
+    for (auto& row : batch) {
+        groups[partition_of(partitioning, row[key])].push_back(std::move(row));
+    }
+    std::vector<size_t> touched;
+    for (size_t i = 0; i < groups.size(); ++i) {
+        if (!groups[i].empty()) {
+            writable_partition(i);
+            touched.push_back(i);
+        }
+    }
+    run_parallel(touched.size(), [&](size_t t) {
+        partitions[touched[t]]->append_batch(std::move(groups[touched[t]]));
+        });
+}
+
+void Table::check_batch(const std::vector<std::vector<Value>>& batch) const {
+    for (size_t c = 0; c < columns.size(); ++c) {
+        const std::string& col_type = column_types.at(columns[c]);
+        Value::Type expected = column_value_type(col_type);
+        auto constraint = constraints.find(columns[c]);
+        bool not_null = (constraint != constraints.end() && constraint->second == "NOT NULL");
+        for (const auto& row : batch) {
+            if (row.size() != columns.size()) {
+                throw std::runtime_error("Row has " + std::to_string(row.size()) + " values, table has " +
+                    std::to_string(columns.size()) + " columns.");
             }
-            return std::any_cast<bool>(it->second) == bool_value;
-            };
+            if (!row[c].has_value()) {
+                if (not_null) {
+                    throw std::runtime_error("Column '" + columns[c] + "' cannot be NULL.");
+                }
+            }
+            else if (row[c].type() != expected) {
+                throw std::runtime_error("Type mismatch for column '" + columns[c] + "': expected " + col_type + ".");
+            }
+        }
+    }
+}
+
+void Table::append_batch(std::vector<std::vector<Value>> batch) {
+    size_t first = rows.size();
+    size_t count = batch.size();
+    if (capture_changes) {
+        changes.inserted.insert(changes.inserted.end(), batch.begin(), batch.end());
     }
+    for (auto& row : batch) {
+        rows.push_back(std::move(row));
+    }
+    zones.append(rows, first);
+    for (auto& [column, index] : indices) {
+        size_t col = column_index(column);
+        for (size_t pos = first; pos < rows.size(); ++pos) {
+            if (rows[pos][col].has_value()) {
+                index.add_entry(rows[pos][col], pos);
+            }
         }
-    //   
-    try {
-        if (!is_numeric(col_value)) {
-            throw std::runtime_error("Invalid integer format in condition: " + col_value);
+    }
+    for (auto& [name, index] : composite_indices) {
+        for (size_t pos = first; pos < rows.size(); ++pos) {
+            index.add_entry(rows[pos], pos);
         }
+    }
+    note_modification(count);
+}
 
-        int int_value = std::stoi(col_value);
-        return [col_name, int_value](const std::map<std::string, std::any>& row) {
-            auto it = row.find(col_name);
-            if (it == row.end() || it->second.type() != typeid(int)) {
-                return false;
+const std::string& Table::get_column_type(const std::string& column) const {
+    auto it = column_types.find(column);
+    if (it == column_types.end()) {
+        throw std::runtime_error("Column " + column + " not found.");
+    }
+    return it->second;
+}
+
+std::shared_ptr<Table> Table::clone() const {
+    auto new_table = std::make_shared<Table>();
+    new_table->columns = this->columns;
+    new_table->column_types = this->column_types;
+    new_table->rows = this->rows;
+    new_table->indices = this->indices;
+    new_table->composite_indices = this->composite_indices;
+    new_table->constraints = this->constraints;
+    new_table->zones = this->zones;
+    new_table->auto_index_policy = this->auto_index_policy;
+    new_table->auto_indexed_columns = this->auto_indexed_columns;
+    new_table->index_decisions = this->index_decisions;
+    {
+        std::lock_guard<std::mutex> usage_lock(usage_mutex);
+        new_table->column_usage = this->column_usage;
+        new_table->query_counter = this->query_counter;
+    }
+    new_table->stats = this->stats;
+    new_table->modified_since_analyze = this->modified_since_analyze;
+    //   :         
+    new_table->partitioning = this->partitioning;
+    new_table->partitions = this->partitions;
+    new_table->dependent_views = this->dependent_views;
+    new_table->view_query = this->view_query;
+    new_table->capture_changes = this->capture_changes;
+    new_table->changes = this->changes;
+    return new_table;
+}
+
+std::vector<std::vector<Value>> Table::all_rows() const {
+    std::vector<std::vector<Value>> result(rows.begin(), rows.end());
+    for (const auto& partition : partitions) {
+        auto part = partition->all_rows();
+        result.insert(result.end(), std::make_move_iterator(part.begin()), std::make_move_iterator(part.end()));
+    }
+    return result;
+}
+
+std::vector<std::vector<Value>> Table::filter_rows(const std::string& condition,
+    std::vector<std::vector<Value>> rows) const {
+    //    :      
+    std::map<std::string, ColumnUsage> trace;
+    auto condition_fn = compile_condition(parse_condition_tree(condition), trace);
+    rows.erase(std::remove_if(rows.begin(), rows.end(),
+        [&](const std::vector<Value>& row) { return !condition_fn(row); }), rows.end());
+    return rows;
+}
+
+size_t Table::remove_rows(const std::vector<std::vector<Value>>& values) {
+    if (values.empty()) {
+        return 0;
+    }
+    std::map<std::vector<Value>, size_t, RowLess> wanted;
+    for (const auto& row : values) {
+        ++wanted[row];
+    }
+    if (is_partitioned()) {
+        size_t removed = 0;
+        for (size_t i = 0; i < partitions.size() && !wanted.empty(); ++i) {
+            std::vector<std::vector<Value>> part_values;
+            for (const auto& row : partitions[i]->rows) {
+                auto it = wanted.find(row);
+                if (it != wanted.end()) {
+                    part_values.push_back(row);
+                    if (--it->second == 0) {
+                        wanted.erase(it);
+                    }
+                }
+            }
+            if (!part_values.empty()) {
+                removed += writable_partition(i).remove_rows(part_values);
+            }
+        }
+        return removed;
+    }
+
+    std::vector<size_t> positions;
+    auto take = [&](size_t pos) {
+        auto it = wanted.find(rows[pos]);
+        if (it != wanted.end()) {
+            positions.push_back(pos);
+            if (--it->second == 0) {
+                wanted.erase(it);
+            }
+        }
+        };
+    if (!composite_indices.empty()) {
+        //  -       (  -    )
+        const CompositeIndex& index = composite_indices.begin()->second;
+        std::set<std::vector<Value>, RowLess> keys;
+        for (const auto& [row, count] : wanted) {
+            keys.insert(index.key_of(row));
+        }
+        for (const auto& key : keys) {
+            for (size_t pos : index.find(key)) {
+                take(pos);
+            }
+        }
+    }
+    else {
+        for (size_t pos = 0; pos < rows.size() && !wanted.empty(); ++pos) {
+            take(pos);
+        }
+    }
+    return is_view() ? erase_rows_unordered(positions) : erase_rows(positions);
+}
+
+size_t Table::erase_rows_unordered(std::vector<size_t> positions) {
+    //     :     ,
+    //          
+    std::sort(positions.begin(), positions.end(), std::greater<size_t>());
+    positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+    ProfileScope scope("delete");
+    scope.set_rows(rows.size(), positions.size());
+    std::vector<size_t> ordinals;
+    for (const auto& [column, index] : indices) {
+        ordinals.push_back(column_index(column));
+    }
+    for (size_t pos : positions) {
+        size_t last = rows.size() - 1;
+        size_t i = 0;
+        for (auto& [column, index] : indices) {
+            index.remove_entry(rows[pos][ordinals[i++]], pos);
+        }
+        for (auto& [name, index] : composite_indices) {
+            index.remove_entry(rows[pos], pos);
+        }
+        if (capture_changes) {
+            changes.deleted.push_back(rows[pos]);
+        }
+        if (pos != last) {
+            i = 0;
+            for (auto& [column, index] : indices) {
+                const Value& key = rows[last][ordinals[i++]];
+                index.remove_entry(key, last);
+                if (key.has_value()) {
+                    index.add_entry(key, pos);
+                }
+            }
+            for (auto& [name, index] : composite_indices) {
+                index.move_entry(rows[last], last, pos);
+            }
+            rows.mutable_row(pos) = std::move(rows.mutable_row(last));
+            for (size_t column = 0; column < columns.size(); ++column) {
+                zones.widen(pos, column, rows[pos][column]);
+            }
+        }
+        rows.pop_back();
+    }
+    //    
+    if (!positions.empty()) {
+        zones.rebuild(rows, rows.empty() ? 0 : rows.size() - 1);
+    }
+    note_modification(positions.size());
+    return positions.size();
+}
+
+std::vector<std::vector<Value>> Table::rows_with_key(const std::vector<size_t>& key_columns,
+    const std::vector<Value>& key) const {
+    std::vector<std::vector<Value>> result;
+    if (!is_partitioned() && !key_columns.empty()) {
+        std::shared_lock<std::shared_mutex> index_lock(index_mutex);
+        for (const auto& [name, index] : composite_indices) {
+            if (index.key_columns() == key_columns) {
+                for (size_t pos : index.find(key)) {
+                    result.push_back(rows[pos]);
+                }
+                return result;
+            }
+        }
+    }
+    for_each_row([&](const std::vector<Value>& row) {
+        for (size_t k = 0; k < key_columns.size(); ++k) {
+            if (compare_cells(row[key_columns[k]], key[k]) != 0) {
+                return;
+            }
+        }
+        result.push_back(row);
+        });
+    return result;
+}
+
+void Table::add_dependent_view(const std::string& name) {
+    dependent_views.insert(name);
+    set_change_capture(true);
+}
+
+void Table::set_change_capture(bool enabled) {
+    capture_changes = enabled;
+    for (size_t i = 0; i < partitions.size(); ++i) {
+        if (partitions[i]->capture_changes != enabled) {
+            writable_partition(i).set_change_capture(enabled);
+        }
+    }
+}
+
+bool Table::has_changes() const {
+    if (!changes.empty()) {
+        return true;
+    }
+    for (const auto& partition : partitions) {
+        if (partition->has_changes()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+RowChanges Table::take_changes() {
+    RowChanges result = std::move(changes);
+    changes = RowChanges();
+    for (size_t i = 0; i < partitions.size(); ++i) {
+        if (!partitions[i]->has_changes()) {
+            continue;
+        }
+        RowChanges part = writable_partition(i).take_changes();
+        result.inserted.insert(result.inserted.end(), std::make_move_iterator(part.inserted.begin()),
+            std::make_move_iterator(part.inserted.end()));
+        result.deleted.insert(result.deleted.end(), std::make_move_iterator(part.deleted.begin()),
+            std::make_move_iterator(part.deleted.end()));
+    }
+    return result;
+}
+
+QueryPlan Table::plan_query(const std::string& condition) const {
+    if (is_partitioned()) {
+        std::vector<size_t> selected = partitions_for(condition);
+        size_t largest = selected.empty() ? 0 : selected.front();
+        for (size_t index : selected) {
+            if (partitions[index]->row_count() > partitions[largest]->row_count()) {
+                largest = index;
+            }
+        }
+        return partitions[largest]->plan_query(condition);
+    }
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex);
+    return build_plan(condition);
+}
+
+QueryPlan Table::build_plan(const std::string& condition) const {
+    std::set<std::string> indexed_columns, text_indexed_columns, bitmap_columns;
+    for (const auto& [column, index] : indices) {
+        indexed_columns.insert(column);
+        if (index.kind() == IndexKind::Text) {
+            text_indexed_columns.insert(column);
+        }
+        else if (index.kind() == IndexKind::Bitmap) {
+            bitmap_columns.insert(column);
+        }
+    }
+    std::map<std::string, std::vector<std::string>> composite_keys;
+    for (const auto& [name, index] : composite_indices) {
+        for (size_t column : index.key_columns()) {
+            composite_keys[name].push_back(columns[column]);
+        }
+    }
+    return make_plan(parse_condition_tree(condition), stats, column_types, indexed_columns, text_indexed_columns,
+        composite_keys, bitmap_columns);
+}
+
+std::vector<size_t> Table::matching_rows(const std::string& condition) const {
+    //     (apply_auto_indexing)     
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex);
+    QueryPlan plan;
+    {
+        ProfileScope scope("plan");
+        plan = build_plan(condition);
+    }
+    return matching_rows(plan);
+}
+
+std::vector<size_t> Table::matching_rows(const QueryPlan& plan) const {
+    if (plan.use_bitmap && plan.bitmap_exact) {
+        ProfileScope scope("bitmap index");
+        {
+            std::lock_guard<std::mutex> usage_lock(usage_mutex);
+            ++query_counter;
+        }
+        std::vector<size_t> result = evaluate_bitmap(plan.condition).to_positions();
+        QueryMemoryCharge memory;
+        memory.set(vector_bytes(result));
+        scope.set_rows(rows.size(), result.size());
+        return result;
+    }
+    ProfileScope scope(plan.use_index ? "index probe" : (plan.use_bitmap ? "bitmap index" : "scan"));
+    if (scope.active()) {
+        scope.set_detail(describe_access(plan));
+    }
+    std::map<std::string, ColumnUsage> trace;
+    auto condition_fn = compile_condition(plan.condition, trace);
+
+    std::vector<size_t> candidates;
+    {
+        std::lock_guard<std::mutex> usage_lock(usage_mutex);
+        ++query_counter;
+        if (plan.use_index && plan.index_columns.empty()) {
+            ColumnUsage& usage = column_usage[plan.index_column];
+            ++usage.index_lookups;
+            usage.last_index_use = query_counter;
+        }
+    }
+    if (plan.use_index && !plan.index_columns.empty()) {
+        candidates = composite_indices.at(plan.index_column).find(plan.index_prefix);
+    }
+    else if (plan.use_bitmap) {
+        candidates = evaluate_bitmap(plan.condition).to_positions();
+    }
+    else if (plan.use_index) {
+        const Index& index = indices.at(plan.index_column);
+        candidates = (plan.index_op == CompareOp::Like)
+            ? index.find_like(std::string(plan.index_key.as_string()))
+            : index.find(plan.index_key);
+    }
+    else {
+        //   ,    
+        std::vector<bool> blocks = zones.candidate_blocks(plan.condition, columns);
+        size_t scanned = 0;
+        for (size_t b = 0; b < blocks.size(); ++b) {
+            if (!blocks[b]) {
+                continue;
+            }
+            ++scanned;
+            size_t end = std::min(rows.size(), (b + 1) * ZoneMap::BLOCK_ROWS);
+            for (size_t i = b * ZoneMap::BLOCK_ROWS; i < end; ++i) {
+                candidates.push_back(i);
+            }
+        }
+        if (scope.active()) {
+            scope.set_detail(describe_access(plan) + ", blocks: " + std::to_string(scanned) + " of " + std::to_string(blocks.size()));
+        }
+    }
+
+    //        . 
+    //      
+    QueryMemoryCharge memory;
+    std::vector<size_t> result;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if ((i & 1023) == 0) {
+            check_query_interrupted();
+            memory.set(vector_bytes(candidates) + vector_bytes(result));
+        }
+        try {
+            if (condition_fn(rows[candidates[i]])) {
+                result.push_back(candidates[i]);
+            }
+        }
+        catch (const std::exception& e) {
+            throw std::runtime_error("Error evaluating condition: " + std::string(e.what()));
+        }
+    }
+
+    scope.set_rows(candidates.size(), result.size());
+    record_usage(trace);
+    return result;
+}
+
+TableMemory Table::memory_usage() const {
+    TableMemory memory;
+    for (const auto& partition : partitions) {
+        TableMemory part = partition->memory_usage();
+        memory.row_bytes += part.row_bytes;
+        memory.zone_map_bytes += part.zone_map_bytes;
+        for (const auto& [name, bytes] : part.index_bytes) {
+            memory.index_bytes[name] += bytes;
+        }
+    }
+
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex);
+    memory.row_bytes += rows.container_bytes();
+    for (const auto& row : rows) {
+        for (const auto& value : row) {
+            memory.row_bytes += value.heap_bytes();
+        }
+    }
+    memory.zone_map_bytes += zones.memory_bytes();
+    for (const auto& [column, index] : indices) {
+        memory.index_bytes[column] += index.memory_bytes();
+    }
+    for (const auto& [name, index] : composite_indices) {
+        memory.index_bytes[name] += index.memory_bytes();
+    }
+    return memory;
+}
+
+RoaringBitmap Table::evaluate_bitmap(const Condition& condition) const {
+    switch (condition.kind) {
+    case Condition::Kind::Constant:
+        return condition.constant ? RoaringBitmap::range(static_cast<uint32_t>(rows.size())) : RoaringBitmap();
+    case Condition::Kind::Compare: {
+        auto it = indices.find(condition.column);
+        if (it == indices.end() || it->second.kind() != IndexKind::Bitmap) {
+            return RoaringBitmap::range(static_cast<uint32_t>(rows.size()));
+        }
+        return it->second.find_bitmap(condition.op, condition.value, rows.size());
+    }
+    case Condition::Kind::Not:
+        return RoaringBitmap::range(static_cast<uint32_t>(rows.size())) - evaluate_bitmap(condition.children[0]);
+    case Condition::Kind::And: {
+        //         
+        std::set<std::string> bitmap_columns;
+        for (const auto& [column, index] : indices) {
+            if (index.kind() == IndexKind::Bitmap) {
+                bitmap_columns.insert(column);
+            }
+        }
+        RoaringBitmap result;
+        bool first = true;
+        for (const auto& child : condition.children) {
+            if (!bitmap_coverage(child, bitmap_columns).known) {
+                continue;
+            }
+            result = first ? evaluate_bitmap(child) : result & evaluate_bitmap(child);
+            first = false;
+            if (result.empty()) {
+                break;
+            }
+        }
+        return first ? RoaringBitmap::range(static_cast<uint32_t>(rows.size())) : result;
+    }
+    case Condition::Kind::Or: {
+        RoaringBitmap result;
+        for (const auto& child : condition.children) {
+            result |= evaluate_bitmap(child);
+        }
+        return result;
+    }
+    }
+    return RoaringBitmap();
+}
+
+size_t Table::count_rows(const std::string& condition) const {
+    if (is_partitioned()) {
+        std::vector<size_t> selected = partitions_for(condition);
+        std::vector<size_t> counts(selected.size());
+        run_parallel(selected.size(), [&](size_t i) {
+            counts[i] = partitions[selected[i]]->count_rows(condition);
+            });
+        size_t total = 0;
+        for (size_t count : counts) {
+            total += count;
+        }
+        return total;
+    }
+
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex);
+    QueryPlan plan;
+    {
+        ProfileScope scope("plan");
+        plan = build_plan(condition);
+    }
+    //      ,   
+    std::set<std::string> bitmap_columns;
+    for (const auto& [column, index] : indices) {
+        if (index.kind() == IndexKind::Bitmap) {
+            bitmap_columns.insert(column);
+        }
+    }
+    if (bitmap_coverage(plan.condition, bitmap_columns).exact) {
+        ProfileScope scope("bitmap count");
+        uint64_t count = evaluate_bitmap(plan.condition).cardinality();
+        scope.set_rows(rows.size(), static_cast<size_t>(count));
+        return static_cast<size_t>(count);
+    }
+    return matching_rows(plan).size();
+}
+
+// ,    .
+static void collect_condition_columns(const Condition& condition, std::set<std::string>& result) {
+    if (condition.kind == Condition::Kind::Compare) {
+        result.insert(condition.column);
+    }
+    for (const auto& child : condition.children) {
+        collect_condition_columns(child, result);
+    }
+}
+
+RowRefs Table::matching_refs(const std::string& condition, const std::vector<size_t>& needed) const {
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex);
+    QueryPlan plan;
+    {
+        ProfileScope scope("plan");
+        plan = build_plan(condition);
+    }
+    auto composite = composite_indices.end();
+    if (plan.use_index && !plan.index_columns.empty()) {
+        composite = composite_indices.find(plan.index_column);
+    }
+    bool covered = composite != composite_indices.end();
+    if (covered) {
+        std::set<std::string> referenced;
+        collect_condition_columns(plan.condition, referenced);
+        for (const auto& column : referenced) {
+            covered = covered && composite->second.covers(column_index(column));
+        }
+        for (size_t column : needed) {
+            covered = covered && composite->second.covers(column);
+        }
+    }
+    if (!covered) {
+        return row_refs(matching_rows(plan));
+    }
+
+    //     :      
+    ProfileScope scope("index only scan");
+    if (scope.active()) {
+        scope.set_detail(describe_access(plan));
+    }
+    std::map<std::string, ColumnUsage> trace;
+    auto condition_fn = compile_condition(plan.condition, trace);
+    {
+        std::lock_guard<std::mutex> usage_lock(usage_mutex);
+        ++query_counter;
+    }
+    RowRefs candidates = composite->second.find_images(plan.index_prefix);
+    QueryMemoryCharge memory;
+    RowRefs result;
+    for (size_t i = 0; i < candidates.size(); ++i) {
+        if ((i & 1023) == 0) {
+            check_query_interrupted();
+            memory.set(vector_bytes(candidates) + vector_bytes(result));
+        }
+        try {
+            if (condition_fn(*candidates[i])) {
+                result.push_back(candidates[i]);
             }
-            return std::any_cast<int>(it->second) == int_value;
+        }
+        catch (const std::exception& e) {
+            throw std::runtime_error("Error evaluating condition: " + std::string(e.what()));
+        }
+    }
+    scope.set_rows(candidates.size(), result.size());
+    record_usage(trace);
+    return result;
+}
+
+void Table::record_usage(const std::map<std::string, ColumnUsage>& trace) const {
+    //          
+    std::lock_guard<std::mutex> usage_lock(usage_mutex);
+    for (const auto& [column, usage] : trace) {
+        ColumnUsage& total = column_usage[column];
+        total.equality_hits += usage.equality_hits;
+        total.range_hits += usage.range_hits;
+        total.rows_evaluated += usage.rows_evaluated;
+        total.rows_matched += usage.rows_matched;
+        total.pending_savings += usage.pending_savings;
+    }
+}
+
+
+Table::RowPredicate Table::compile_condition(const Condition& condition, std::map<std::string, ColumnUsage>& trace) const {
+    switch (condition.kind) {
+    case Condition::Kind::Constant: {
+        bool constant = condition.constant;
+        return [constant](const std::vector<Value>&) { return constant; };
+    }
+    case Condition::Kind::Compare:
+        return compile_compare(condition, trace);
+    case Condition::Kind::Not: {
+        auto inner = compile_condition(condition.children[0], trace);
+        return [inner](const std::vector<Value>& row) { return !inner(row); };
+    }
+    case Condition::Kind::And:
+    case Condition::Kind::Or: {
+        //    ,     
+        std::vector<RowPredicate> parts;
+        for (const auto& child : condition.children) {
+            parts.push_back(compile_condition(child, trace));
+        }
+        if (condition.kind == Condition::Kind::And) {
+            return [parts](const std::vector<Value>& row) {
+                for (const auto& part : parts) {
+                    if (!part(row)) return false;
+                }
+                return true;
+                };
+        }
+        return [parts](const std::vector<Value>& row) {
+            for (const auto& part : parts) {
+                if (part(row)) return true;
+            }
+            return false;
             };
     }
-    catch (const std::exception& e) {
-        throw std::runtime_error("Failed to parse integer value in condition: " + col_value + ", error: " + e.what());
     }
+    throw std::runtime_error("Unsupported condition.");
 }
 
+Table::RowPredicate Table::compile_compare(const Condition& condition, std::map<std::string, ColumnUsage>& trace) const {
+    size_t col = column_index(condition.column);
+    CompareOp op = condition.op;
+    Value value = condition.value;
+
+    RowPredicate predicate;
+    if (!value.has_value()) {
+        //   NULL: "col=NULL"    , "col!=NULL" -  
+        bool want_null = (op == CompareOp::Eq);
+        predicate = [col, want_null](const std::vector<Value>& row) {
+            return row[col].has_value() != want_null;
+            };
+    }
+    else if (op == CompareOp::Like) {
+        if (!value.is_string()) {
+            throw std::runtime_error("LIKE expects a string pattern for column " + condition.column + ".");
+        }
+        std::string pattern(value.as_string());
+        predicate = [col, pattern](const std::vector<Value>& row) {
+            return row[col].is_string() && like_matches(pattern, row[col].as_string());
+            };
+    }
+    //        ,     
+    else if (value.is_int()) {
+        int32_t target = value.as_int();
+        predicate = [col, op, target](const std::vector<Value>& row) {
+            const auto& cell = row[col];
+            return cell.is_int() && compare_matches(op, (cell.as_int() > target) - (cell.as_int() < target));
+            };
+    }
+    else if (value.is_string()) {
+        std::string target(value.as_string());
+        predicate = [col, op, target](const std::vector<Value>& row) {
+            const auto& cell = row[col];
+            if (!cell.is_string()) {
+                return false;
+            }
+            int result = cell.as_string().compare(target);
+            return compare_matches(op, (result > 0) - (result < 0));
+            };
+    }
+    else {
+        predicate = [col, op, value](const std::vector<Value>& row) {
+            const auto& cell = row[col];
+            return values_comparable(cell, value) && compare_matches(op, compare_values(cell, value));
+            };
+    }
 
+    //    :    apply_auto_indexing ,   
+    ColumnUsage* usage = &trace[condition.column];
+    bool indexable = (op == CompareOp::Eq && value.has_value());
+    if (op == CompareOp::Eq) {
+        ++usage->equality_hits;
+    }
+    else {
+        ++usage->range_hits;
+    }
+    return [predicate, usage, indexable](const std::vector<Value>& row) {
+        bool matched = predicate(row);
+        ++usage->rows_evaluated;
+        if (matched) {
+            ++usage->rows_matched;
+        }
+        else if (indexable) {
+            ++usage->pending_savings;
+        }
+        return matched;
         };
+}
+
+Table::RowExpression Table::compile_expression(const Expression& expression, std::string& result_type) const {
+    switch (expression.kind) {
+    case Expression::Kind::Literal: {
+        Value value = expression.value;
+        if (!value.has_value()) {
+            result_type.clear();
+        }
+        else if (value.is_int()) {
+            result_type = "int32";
+        }
+        else if (value.is_string()) {
+            result_type = "string";
+        }
+        else if (value.is_bool()) {
+            result_type = "bool";
+        }
+        else {
+            throw std::runtime_error("Unsupported literal in expression.");
+        }
+        return [value](const std::vector<Value>&) { return value; };
+    }
+    case Expression::Kind::Column: {
+        size_t col = column_index(expression.column);
+        result_type = column_types.at(expression.column);
+        return [col](const std::vector<Value>& row) { return row[col]; };
+    }
+    case Expression::Kind::Binary:
+        break;
+    }
+
+    std::string left_type, right_type;
+    RowExpression left = compile_expression(expression.operands[0], left_type);
+    RowExpression right = compile_expression(expression.operands[1], right_type);
+    char op = expression.op;
+
+    // NULL-    ;   NULL- - NULL
+    if (left_type.empty()) {
+        left_type = right_type;
+    }
+    if (right_type.empty()) {
+        right_type = left_type;
+    }
+    if (left_type != right_type) {
+        throw std::runtime_error("Type mismatch in expression: " + expression_to_string(expression));
+    }
+    result_type = left_type;
+
+    if (result_type == "string" && op == '+') {
+        return [left, right](const std::vector<Value>& row) -> Value {
+            Value a = left(row);
+            Value b = right(row);
+            if (!a.has_value() || !b.has_value()) {
+                return Value();
+            }
+            std::string joined(a.as_string());
+            joined += b.as_string();
+            return joined;
+            };
+    }
+    if (result_type != "int32" && !result_type.empty()) {
+        throw std::runtime_error("Operator '" + std::string(1, op) + "' is not defined for " + result_type + ": " +
+            expression_to_string(expression));
+    }
+    if (result_type.empty()) {
+        //   - NULL-
+        return [](const std::vector<Value>&) { return Value(); };
+    }
+
+    return [left, right, op](const std::vector<Value>& row) -> Value {
+        Value a = left(row);
+        Value b = right(row);
+        if (!a.has_value() || !b.has_value()) {
+            return Value();
+        }
+        //   64 :  int32 (   INT_MIN / -1) - ,   UB
+        int64_t x = a.as_int();
+        int64_t y = b.as_int();
+        int64_t result = 0;
+        switch (op) {
+        case '+': result = x + y; break;
+        case '-': result = x - y; break;
+        case '*': result = x * y; break;
+        default:
+            if (y == 0) {
+                throw std::runtime_error("Division by zero in UPDATE expression.");
+            }
+            result = op == '/' ? x / y : x % y;
+            break;
+        }
+        if (result < std::numeric_limits<int32_t>::min() || result > std::numeric_limits<int32_t>::max() ||
+            (op == '%' && x == std::numeric_limits<int32_t>::min() && y == -1)) {
+            throw std::runtime_error("Integer overflow in UPDATE expression.");
+        }
+        return static_cast<int32_t>(result);
         };
-        };
-        };
-        };
+}
 
 
+void Table::analyze() {
+    stats = TableStats();
+    stats.analyzed = true;
+    if (is_partitioned()) {
+        for (size_t i = 0; i < partitions.size(); ++i) {
+            writable_partition(i);
+        }
+        run_parallel(partitions.size(), [&](size_t i) {
+            partitions[i]->analyze();
+            });
+        stats.row_count = row_count();
+        modified_since_analyze = 0;
+        return;
+    }
+    stats.row_count = rows.size();
+    // ,   UPDATE,       
+    if (zones.is_widened()) {
+        zones = ZoneMap();
+        zones.rebuild(rows);
+    }
+    for (size_t i = 0; i < columns.size(); ++i) {
+        std::vector<Value> values;
+        values.reserve(rows.size());
+        for (const auto& row : rows) {
+            values.push_back(row[i]);
+        }
+        stats.columns[columns[i]] = compute_column_stats(std::move(values));
+    }
+    modified_since_analyze = 0;
+}
 
+const TableStats& Table::get_statistics() const {
+    return stats;
+}
 
+std::string Table::describe_statistics() const {
+    std::ostringstream out;
+    if (is_partitioned()) {
+        out << "partitioning: " << describe_partitioning(partitioning) << "\n";
+        for (size_t i = 0; i < partitions.size(); ++i) {
+            out << "partition " << i << ":\n" << partitions[i]->describe_statistics();
+        }
+        return out.str();
+    }
+    out << "rows: " << stats.row_count << (stats.analyzed ? "" : " (not analyzed)") << "\n";
+    for (const auto& column : columns) {
+        auto it = stats.columns.find(column);
+        if (it == stats.columns.end()) {
+            continue;
+        }
+        const ColumnStats& column_stats = it->second;
+        out << "column: " << column
+            << ", distinct: " << column_stats.distinct_count
+            << ", nulls: " << column_stats.null_count;
+        if (column_stats.min_value.has_value()) {
+            out << ", min: " << format_literal(column_stats.min_value)
+                << ", max: " << format_literal(column_stats.max_value);
+        }
+        if (!column_stats.histogram.empty()) {
+            out << ", histogram buckets: " << column_stats.histogram.size() - 1;
+        }
+        out << "\n";
+    }
+    return out.str();
+}
+
+//   ,     .
+void Table::note_modification(size_t row_count) {
+    static const size_t AUTO_ANALYZE_MIN_ROWS = 50;
+    stats.row_count = rows.size();
+    modified_since_analyze += row_count;
+    if (modified_since_analyze > std::max(AUTO_ANALYZE_MIN_ROWS, rows.size() / 5)) {
+        analyze();
+    }
+}
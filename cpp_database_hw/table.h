@@ -2,31 +2,160 @@
 #define TABLE_H
 
 #include <map>
+#include <set>
 #include <vector>
 #include <string>
-#include <any>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <iostream>
+#include "expression.h"
+#include "index.h"
+#include "memory_usage.h"
+#include "partition.h"
+#include "planner.h"
+#include "result_batch.h"
+#include "row_store.h"
+#include "sort.h"
+#include "value.h"
+#include "zone_map.h"
 
-class Index {
-public:
-    void add_entry(const std::any& value, size_t row_index);
+//    ,      .
+struct ColumnUsage {
+    size_t equality_hits = 0;   //      
+    size_t range_hits = 0;      //   -  
+    size_t rows_evaluated = 0;  // ,      
+    size_t rows_matched = 0;    // ,   
+    size_t index_lookups = 0;   // ,  
+    size_t last_index_use = 0;  //  ,      
+    size_t pending_savings = 0; // ,      
+};
+
+//      .
+struct AutoIndexPolicy {
+    bool enabled = true;
+    size_t min_equality_hits = 2;      //      
+    double build_cost_factor = 2.0;    //       
+    bool drop_unused = false;          //  ,    
+    size_t unused_after_queries = 1000;
+};
+
+//       (  
+//  ). UPDATE        .
+struct RowChanges {
+    std::vector<std::vector<Value>> inserted;
+    std::vector<std::vector<Value>> deleted;
+
+    bool empty() const { return inserted.empty() && deleted.empty(); }
 };
 
 class Table {
 public:
-    Table(const std::map<std::string, std::string>& schema);
+    // partitioning         ;
+    //      ,   .
+    Table(const std::map<std::string, std::string>& schema, const PartitionScheme& partitioning = {});
     Table() = default;
 
-    void insert(const std::map<std::string, std::any>& values);
-    void remove(const std::string& condition);
-    void update(const std::string& condition, const std::map<std::string, std::any>& updates);
-    std::vector<std::map<std::string, std::any>> select(const std::string& condition) const;
-    bool is_unique(const std::string& column_name, const std::any& value) const;
+    void insert(const std::map<std::string, Value>& values);
+    // remove  update      .
+    size_t remove(const std::string& condition);
+    size_t update(const std::string& condition, const std::map<std::string, Value>& updates);
+    //       (SET a = b, b = a   ).
+    size_t update(const std::string& condition, const std::vector<Assignment>& assignments);
+    std::vector<std::map<std::string, Value>> select(const std::string& condition) const;
+    //    ;    -   .
+    // order  ORDER BY/LIMIT/OFFSET, sort_options -   .
+    ResultBatch select_batch(const std::string& condition, const std::vector<std::string>& projection = {},
+        const SelectOrder& order = {}, const SortOptions& sort_options = {}) const;
+    bool is_unique(const std::string& column_name, const Value& value) const;
+    //  ,   (COUNT(*)).    
+    //   ,  -    ,    .
+    size_t count_rows(const std::string& condition) const;
 
-    void create_index(const std::string& column);
+    //    (    ):  
+    //       ,    .
+    void insert_batch(std::vector<std::vector<Value>> batch);
+    //  [first, first + count)   ,   .
+    ResultBatch scan_batch(size_t first, size_t count, const std::vector<std::string>& projection = {}) const;
+    size_t row_count() const;
+    const std::vector<std::string>& get_columns() const { return columns; }
+    const std::string& get_column_type(const std::string& column) const;
+
+    // IndexKind::Text -    ,  LIKE;
+    // IndexKind::Bitmap    bool.
+    void create_index(const std::string& column, IndexKind kind = IndexKind::Hash);
     void auto_index(const std::string& column);
+    //     int32, string  bool     ;
+    // included_columns (INCLUDE)   ,  SELECT,  
+    //    ,     .   .
+    std::string create_composite_index(const std::vector<std::string>& key_columns,
+        const std::vector<std::string>& included_columns = {});
+    bool has_composite_index(const std::vector<std::string>& key_columns) const;
+
+    //        .
+    void apply_auto_indexing();
+    void set_auto_index_policy(const AutoIndexPolicy& policy);
+    const AutoIndexPolicy& get_auto_index_policy() const;
+
+    //    ,     .
+    std::string describe_indices() const;
+
+    //   ,      (  ).
+    TableMemory memory_usage() const;
+
+    //    (ANALYZE).
+    void analyze();
+    const TableStats& get_statistics() const;
+    std::string describe_statistics() const;
+
+    //         WHERE.
+    //    -      .
+    QueryPlan plan_query(const std::string& condition) const;
+
+    bool is_partitioned() const { return !partitions.empty(); }
+    const PartitionScheme& get_partitioning() const { return partitioning; }
+    const Table& get_partition(size_t index) const { return *partitions.at(index); }
+    //  ,      .
+    std::vector<size_t> partitions_for(const std::string& condition) const;
+
+    //    (   -  ).
+    std::vector<std::vector<Value>> all_rows() const;
+    //      (TypedTable): visit   
+    //   ;     .
+    template <typename Visit>
+    void for_each_row(Visit&& visit) const;
+    // ,      column  key,    , 
+    //   column=key (key   -  ).   
+    //       .
+    template <typename Visit>
+    void for_each_equal(size_t column, const Value& key, Visit&& visit) const;
+    //   rows (   ),  .
+    std::vector<std::vector<Value>> filter_rows(const std::string& condition,
+        std::vector<std::vector<Value>> rows) const;
+    // ,    key_columns  key (NULL   NULL); 
+    //      ,   ,  .
+    std::vector<std::vector<Value>> rows_with_key(const std::vector<size_t>& key_columns,
+        const std::vector<Value>& key) const;
+    //        values;   .
+    //      ,   .
+    size_t remove_rows(const std::vector<std::vector<Value>>& values);
+
+    //  .      
+    // ,    ,     take_changes.
+    //       .
+    void add_dependent_view(const std::string& name);
+    const std::set<std::string>& get_dependent_views() const { return dependent_views; }
+    bool has_changes() const;
+    RowChanges take_changes();
+    void set_view_query(const std::string& query) { view_query = query; }
+    const std::string& get_view_query() const { return view_query; }
+    bool is_view() const { return !view_query.empty(); }
+
+    //  :         
+    //   Database::get_table_for_write (    ).
+    uint64_t get_version() const { return version; }
+    void bump_version() { version = next_version(); }
 
     void save(std::ostream& os) const;
     void load(std::istream& is);
@@ -35,12 +164,129 @@ public:
 private:
     std::vector<std::string> columns;
     std::map<std::string, std::string> column_types;
-    std::vector<std::vector<std::any>> rows;
+    RowStore rows;  //          
     std::map<std::string, Index> indices;
+    std::map<std::string, CompositeIndex> composite_indices; //   "a,b"
     std::map<std::string, std::string> constraints;
+    ZoneMap zones;  //   :   ,   
+
+    AutoIndexPolicy auto_index_policy;
+    std::set<std::string> auto_indexed_columns;
+    std::vector<std::string> index_decisions;
+    mutable std::map<std::string, ColumnUsage> column_usage;
+    mutable size_t query_counter = 0;
+
+    //   (SELECT)     usage_mutex,
+    //  apply_auto_indexing      index_mutex.
+    mutable std::mutex usage_mutex;
+    mutable std::shared_mutex index_mutex;
+
+    TableStats stats;
+    size_t modified_since_analyze = 0;
+
+    //        (, )
+    //     ,      Database.
+    PartitionScheme partitioning;
+    std::vector<std::shared_ptr<Table>> partitions;
+
+    uint64_t version = next_version();
+
+    std::set<std::string> dependent_views;
+    std::string view_query;
+    bool capture_changes = false;
+    RowChanges changes;
 
-    std::function<bool(const std::map<std::string, std::any>&)> parse_condition(const std::string& condition) const;
-    std::function<bool(const std::map<std::string, std::any>&)> parse_simple_condition(const std::string& condition) const;
+    static uint64_t next_version();
+
+    using RowPredicate = std::function<bool(const std::vector<Value>&)>;
+    RowPredicate compile_condition(const Condition& condition, std::map<std::string, ColumnUsage>& trace) const;
+    RowPredicate compile_compare(const Condition& condition, std::map<std::string, ColumnUsage>& trace) const;
+
+    //  SET,       .
+    // result_type -   ("int32", "string", "bool"    NULL).
+    using RowExpression = std::function<Value(const std::vector<Value>&)>;
+    RowExpression compile_expression(const Expression& expression, std::string& result_type) const;
+
+    struct UpdateStep {
+        size_t column;
+        RowExpression value;
+    };
+    std::vector<UpdateStep> compile_assignments(const std::vector<Assignment>& assignments, std::set<std::string>& assigned) const;
+    //     ,       .
+    std::vector<Value> evaluate_update(const std::vector<size_t>& matched, const std::vector<UpdateStep>& steps) const;
+    void apply_update(const std::vector<size_t>& matched, std::vector<Value> values,
+        const std::vector<UpdateStep>& steps, const std::set<std::string>& assigned);
+    size_t update_partitions(const std::string& condition, const std::vector<UpdateStep>& steps, const std::set<std::string>& assigned);
+
+    //  ,   ( ,   ).
+    std::vector<size_t> matching_rows(const std::string& condition) const;
+    //    index_mutex.
+    QueryPlan build_plan(const std::string& condition) const;
+    std::vector<size_t> matching_rows(const QueryPlan& plan) const;
+    // ,  ;     , 
+    //    needed  , -     .
+    RowRefs matching_refs(const std::string& condition, const std::vector<size_t>& needed) const;
+    void record_usage(const std::map<std::string, ColumnUsage>& trace) const;
+    //     ;         .
+    RoaringBitmap evaluate_bitmap(const Condition& condition) const;
+    void note_modification(size_t row_count);
+    size_t column_index(const std::string& column) const;
+    RowRefs row_refs(const std::vector<size_t>& positions) const;
+    ResultBatch make_batch(const RowRefs& rows, const std::vector<std::string>& projection) const;
+    void check_batch(const std::vector<std::vector<Value>>& batch) const;
+    void append_batch(std::vector<std::vector<Value>> batch);
+    size_t erase_rows(const std::vector<size_t>& positions);
+    size_t erase_rows_unordered(std::vector<size_t> positions);
+    std::shared_ptr<Table> make_partition() const;
+    Table& writable_partition(size_t index);
+    void set_change_capture(bool enabled);
+    void save_view_links(ByteWriter& out) const;
+    void load_view_links(ByteReader& in);
+    void load_partitioned(std::istream& is);
+    void load_text(std::istream& is);
+    void rebuild_index(const std::string& column);
+    void rebuild_indices();
+    void rebuild_composite_index(CompositeIndex& index);
 };
 
+template <typename Visit>
+void Table::for_each_row(Visit&& visit) const {
+    for (const auto& partition : partitions) {
+        partition->for_each_row(visit);
+    }
+    for (const auto& row : rows) {
+        visit(row);
+    }
+}
+
+template <typename Visit>
+void Table::for_each_equal(size_t column, const Value& key, Visit&& visit) const {
+    if (is_partitioned()) {
+        if (columns.at(column) == partitioning.column && key.has_value() &&
+            key.type() == column_value_type(column_types.at(partitioning.column))) {
+            partitions[partition_of(partitioning, key)]->for_each_equal(column, key, visit);
+            return;
+        }
+        for (const auto& partition : partitions) {
+            partition->for_each_equal(column, key, visit);
+        }
+        return;
+    }
+
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex);
+    auto index = key.has_value() ? indices.find(columns.at(column)) : indices.end();
+    if (index != indices.end()) {
+        for (size_t position : index->second.find(key)) {
+            visit(rows[position]);
+        }
+        return;
+    }
+    for (const auto& row : rows) {
+        const Value& cell = row[column];
+        if (key.has_value() ? (cell.same_type(key) && compare_values(cell, key) == 0) : !cell.has_value()) {
+            visit(row);
+        }
+    }
+}
+
 #endif // TABLE_H
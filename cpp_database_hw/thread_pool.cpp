@@ -0,0 +1,114 @@
+#include "thread_pool.h"
+#include <stdexcept>
+
+//   ,    (    ).
+static thread_local const ThreadPool* current_pool = nullptr;
+static thread_local size_t current_worker = 0;
+
+ThreadPool::ThreadPool(size_t thread_count, size_t queue_capacity) : capacity(queue_capacity) {
+    if (thread_count == 0 || queue_capacity == 0) {
+        throw std::invalid_argument("Thread pool needs at least one thread and one queue slot.");
+    }
+    for (size_t i = 0; i < thread_count; ++i) {
+        queues.push_back(std::make_unique<WorkerQueue>());
+    }
+    for (size_t i = 0; i < thread_count; ++i) {
+        workers.emplace_back([this, i]() { worker_loop(i); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        stopping = true;
+    }
+    work_available.notify_all();
+    space_available.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    std::unique_lock<std::mutex> lock(state_mutex);
+    space_available.wait(lock, [this]() { return stopping || pending < capacity; });
+    if (stopping) {
+        throw std::runtime_error("Thread pool is shutting down.");
+    }
+    enqueue(std::move(task));
+    lock.unlock();
+    work_available.notify_one();
+}
+
+bool ThreadPool::try_submit(std::function<void()> task) {
+    std::unique_lock<std::mutex> lock(state_mutex);
+    if (stopping || pending >= capacity) {
+        return false;
+    }
+    enqueue(std::move(task));
+    lock.unlock();
+    work_available.notify_one();
+    return true;
+}
+
+size_t ThreadPool::queued() const {
+    std::lock_guard<std::mutex> lock(state_mutex);
+    return pending;
+}
+
+//   state_mutex.
+void ThreadPool::enqueue(std::function<void()> task) {
+    // ,   ,    ;    
+    size_t target = (current_pool == this) ? current_worker : next_queue++ % queues.size();
+    {
+        std::lock_guard<std::mutex> queue_lock(queues[target]->mutex);
+        queues[target]->tasks.push_back(std::move(task));
+    }
+    ++pending;
+}
+
+bool ThreadPool::pop_task(size_t self, std::function<void()>& task) {
+    //      ,  -  
+    {
+        WorkerQueue& own = *queues[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < queues.size(); ++offset) {
+        WorkerQueue& victim = *queues[(self + offset) % queues.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::worker_loop(size_t self) {
+    current_pool = this;
+    current_worker = self;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(state_mutex);
+            work_available.wait(lock, [this]() { return stopping || pending > 0; });
+            if (pending == 0) {
+                return;
+            }
+            //   :       
+            --pending;
+        }
+        space_available.notify_one();
+
+        std::function<void()> task;
+        while (!pop_task(self, task)) {
+            std::this_thread::yield();
+        }
+        task();
+    }
+}
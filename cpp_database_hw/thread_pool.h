@@ -0,0 +1,56 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//            .
+//     :   submit .
+class ThreadPool {
+public:
+    ThreadPool(size_t thread_count, size_t queue_capacity);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    //    ,    ( ).
+    //          .
+    //     .
+    void submit(std::function<void()> task);
+
+    //      ; false,   .
+    bool try_submit(std::function<void()> task);
+
+    size_t thread_count() const { return workers.size(); }
+    size_t queued() const;
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    size_t capacity;
+
+    mutable std::mutex state_mutex;
+    std::condition_variable work_available;
+    std::condition_variable space_available;
+    size_t pending = 0;            //    ( state_mutex)
+    bool stopping = false;
+    std::atomic<size_t> next_queue{ 0 };
+
+    void enqueue(std::function<void()> task);
+    bool pop_task(size_t self, std::function<void()>& task);
+    void worker_loop(size_t self);
+};
+
+#endif // THREAD_POOL_H
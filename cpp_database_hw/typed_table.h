@@ -0,0 +1,281 @@
+#ifndef TYPED_TABLE_H
+#define TYPED_TABLE_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_set>
+#include <vector>
+#include "database.h"
+#include "value.h"
+
+//     : Column<"id", &User::id>.
+template <size_t N>
+struct ColumnName {
+    char text[N];
+
+    constexpr ColumnName(const char (&name)[N]) { std::copy_n(name, N, text); }
+    constexpr std::string_view view() const { return std::string_view(text, N - 1); }
+};
+
+//  ,     .
+template <ColumnName Name, auto Member>
+struct Column {
+    static constexpr std::string_view name = Name.view();
+    static constexpr auto member = Member;
+};
+
+//     : int32_t, std::string, bool  std::optional
+//   ( optional - NULL). View - ,        .
+template <typename Field>
+struct FieldTraits;
+
+template <>
+struct FieldTraits<int32_t> {
+    using View = int32_t;
+    static constexpr const char* type = "int32";
+    static Value to_value(View value) { return Value(value); }
+    static View view(const Value& cell) { return cell.as_int(); }
+    static int32_t read(const Value& cell) { return cell.as_int(); }
+};
+
+template <>
+struct FieldTraits<bool> {
+    using View = bool;
+    static constexpr const char* type = "bool";
+    static Value to_value(View value) { return Value(value); }
+    static View view(const Value& cell) { return cell.as_bool(); }
+    static bool read(const Value& cell) { return cell.as_bool(); }
+};
+
+template <>
+struct FieldTraits<std::string> {
+    using View = std::string_view;
+    static constexpr const char* type = "string";
+    static Value to_value(View value) { return Value(value); }
+    static View view(const Value& cell) { return cell.as_string(); }
+    static std::string read(const Value& cell) { return std::string(cell.as_string()); }
+};
+
+template <typename Field>
+struct FieldTraits<std::optional<Field>> {
+    using View = std::optional<typename FieldTraits<Field>::View>;
+    static constexpr const char* type = FieldTraits<Field>::type;
+    static Value to_value(const View& value) { return value ? FieldTraits<Field>::to_value(*value) : Value(); }
+    static View view(const Value& cell) {
+        return cell.has_value() ? View(FieldTraits<Field>::view(cell)) : std::nullopt;
+    }
+    static std::optional<Field> read(const Value& cell) {
+        return cell.has_value() ? std::optional<Field>(FieldTraits<Field>::read(cell)) : std::nullopt;
+    }
+};
+
+//          C++.  
+//       :
+//   struct User { int32_t id; std::string name; bool is_admin; };
+//   using Users = TypedTable<User, Column<"id", &User::id>, Column<"is_admin", &User::is_admin>,
+//       Column<"name", &User::name>>;
+//   (   )   , 
+// insert, find_by   select    ,   SQL,
+//       .      
+// Table,    SQL,    ( ).
+template <typename Row, typename... Columns>
+class TypedTable {
+public:
+    static_assert(sizeof...(Columns) > 0, "TypedTable needs at least one column.");
+
+    //       Member.
+    template <auto Member>
+    static constexpr size_t ordinal() {
+        size_t result = sizeof...(Columns);
+        ((same_member<Columns::member, Member>() ? (result = rank(Columns::name)) : 0), ...);
+        return result;
+    }
+
+    template <auto Member>
+    using FieldOf = std::remove_cvref_t<decltype(std::declval<Row&>().*Member)>;
+
+    //  ,   : row.get<&User::name>() ( -  string_view).
+    class RowView {
+    public:
+        explicit RowView(const std::vector<Value>& cells) : cells(cells) {}
+
+        template <auto Member>
+        typename FieldTraits<FieldOf<Member>>::View get() const {
+            static_assert(ordinal<Member>() < sizeof...(Columns), "Field is not mapped to a column.");
+            return FieldTraits<FieldOf<Member>>::view(cells[ordinal<Member>()]);
+        }
+
+        Row to_row() const { return TypedTable::read_row(cells); }
+
+    private:
+        const std::vector<Value>& cells;
+    };
+
+    //    ;        .
+    TypedTable(Database& db, std::string table_name) : db(db), table_name(std::move(table_name)) {
+        db.read_table(this->table_name, [this](const Table& table) { check_schema(table); });
+    }
+
+    //    .
+    static TypedTable create(Database& db, const std::string& table_name) {
+        db.create_table(table_name, schema());
+        return TypedTable(db, table_name);
+    }
+
+    static std::map<std::string, std::string> schema() {
+        std::map<std::string, std::string> result;
+        ((result[std::string(Columns::name)] = FieldTraits<FieldOf<Columns::member>>::type), ...);
+        return result;
+    }
+
+    //     ,   INSERT (    id).
+    void insert(const Row& row) {
+        insert(std::vector<Row>{ row });
+    }
+
+    void insert(const std::vector<Row>& rows) {
+        std::vector<std::vector<Value>> batch;
+        batch.reserve(rows.size());
+        for (const auto& row : rows) {
+            batch.push_back(make_cells(row));
+        }
+        db.write_table(table_name, [&](Table& table) {
+            check_unique_ids(table, batch);
+            table.insert_batch(std::move(batch));
+            });
+    }
+
+    // ,    Member  value (   ,   ).
+    template <auto Member>
+    std::vector<Row> find_by(typename FieldTraits<FieldOf<Member>>::View value) const {
+        static_assert(ordinal<Member>() < sizeof...(Columns), "Field is not mapped to a column.");
+        Value key = FieldTraits<FieldOf<Member>>::to_value(value);
+        std::vector<Row> result;
+        db.read_table(table_name, [&](const Table& table) {
+            table.for_each_equal(ordinal<Member>(), key, [&](const std::vector<Value>& cells) {
+                result.push_back(read_row(cells));
+                });
+            });
+        return result;
+    }
+
+    // ,   predicate(const RowView&) ;     .
+    template <typename Predicate>
+    std::vector<Row> select(Predicate predicate) const {
+        std::vector<Row> result;
+        db.read_table(table_name, [&](const Table& table) {
+            table.for_each_row([&](const std::vector<Value>& cells) {
+                if (predicate(RowView(cells))) {
+                    result.push_back(read_row(cells));
+                }
+                });
+            });
+        return result;
+    }
+
+    template <typename Predicate>
+    size_t count(Predicate predicate) const {
+        size_t result = 0;
+        db.read_table(table_name, [&](const Table& table) {
+            table.for_each_row([&](const std::vector<Value>& cells) {
+                if (predicate(RowView(cells))) {
+                    ++result;
+                }
+                });
+            });
+        return result;
+    }
+
+    const std::string& get_name() const { return table_name; }
+
+private:
+    Database& db;
+    std::string table_name;
+
+    template <auto Left, auto Right>
+    static constexpr bool same_member() {
+        if constexpr (std::is_same_v<decltype(Left), decltype(Right)>) {
+            return Left == Right;
+        }
+        else {
+            return false;
+        }
+    }
+
+    //     :  -    .
+    static constexpr size_t rank(std::string_view name) {
+        return (size_t(0) + ... + (Columns::name < name ? 1 : 0));
+    }
+
+    static constexpr bool distinct_names() {
+        std::string_view names[] = { Columns::name... };
+        for (size_t i = 0; i < sizeof...(Columns); ++i) {
+            for (size_t j = i + 1; j < sizeof...(Columns); ++j) {
+                if (names[i] == names[j]) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+    static_assert(distinct_names(), "TypedTable column names must be distinct.");
+
+    static std::vector<Value> make_cells(const Row& row) {
+        std::vector<Value> cells(sizeof...(Columns));
+        ((cells[rank(Columns::name)] = FieldTraits<FieldOf<Columns::member>>::to_value(row.*Columns::member)), ...);
+        return cells;
+    }
+
+    static Row read_row(const std::vector<Value>& cells) {
+        Row row{};
+        ((row.*Columns::member = FieldTraits<FieldOf<Columns::member>>::read(cells[rank(Columns::name)])), ...);
+        return row;
+    }
+
+    static void check_schema(const Table& table) {
+        const auto& columns = table.get_columns();
+        std::map<std::string, std::string> expected = schema();
+        bool matches = columns.size() == expected.size();
+        for (size_t i = 0; matches && i < columns.size(); ++i) {
+            auto it = expected.find(columns[i]);
+            matches = it != expected.end() && table.get_column_type(columns[i]) == it->second;
+        }
+        if (!matches) {
+            throw std::runtime_error("Table schema does not match the typed row declaration.");
+        }
+    }
+
+    //  INSERT: id      ,   .
+    static void check_unique_ids(const Table& table, const std::vector<std::vector<Value>>& batch) {
+        if constexpr (((Columns::name == "id") || ...)) {
+            constexpr size_t id = rank("id");
+            //    id   ,      
+            std::unordered_set<int32_t> ids;
+            if (batch.size() > 1) {
+                table.for_each_row([&](const std::vector<Value>& cells) {
+                    if (cells[id].is_int()) {
+                        ids.insert(cells[id].as_int());
+                    }
+                    });
+            }
+            for (const auto& cells : batch) {
+                if (!cells[id].is_int()) {
+                    continue;
+                }
+                int32_t value = cells[id].as_int();
+                if (!ids.insert(value).second || (batch.size() == 1 && !table.is_unique("id", value))) {
+                    throw std::runtime_error("Duplicate ID detected: " + std::to_string(value));
+                }
+            }
+        }
+    }
+};
+
+#endif // TYPED_TABLE_H
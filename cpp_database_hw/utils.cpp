@@ -1,6 +1,8 @@
 #include "utils.h"
 #include <algorithm>
 #include <cctype>
+#include <sstream>
+#include <stdexcept>
 
 //        .
 std::string trim(const std::string& str) {
@@ -34,3 +36,80 @@ bool is_numeric(const std::string& str) {
 
     return true;
 }
+
+uint64_t stable_hash(const Value& value) {
+    uint64_t hash = 14695981039346656037ull;
+    auto feed = [&hash](unsigned char byte) {
+        hash ^= byte;
+        hash *= 1099511628211ull;
+        };
+    if (value.is_int()) {
+        uint32_t bits = static_cast<uint32_t>(value.as_int());
+        for (int i = 0; i < 4; ++i) {
+            feed(static_cast<unsigned char>(bits >> (8 * i)));
+        }
+    }
+    else if (value.is_string()) {
+        for (char c : value.as_string()) {
+            feed(static_cast<unsigned char>(c));
+        }
+    }
+    else if (value.is_bool()) {
+        feed(value.as_bool() ? 1 : 0);
+    }
+    else {
+        throw std::runtime_error("Unsupported type for hashing.");
+    }
+    return hash;
+}
+
+size_t find_keyword(const std::string& text, const std::string& keyword, size_t from) {
+    bool in_quotes = false;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '\'') {
+            in_quotes = !in_quotes;
+        }
+        else if (!in_quotes && i >= from && text.compare(i, keyword.size(), keyword) == 0 &&
+            (i == 0 || std::isspace(static_cast<unsigned char>(text[i - 1]))) &&
+            (i + keyword.size() == text.size() || std::isspace(static_cast<unsigned char>(text[i + keyword.size()])))) {
+            return i;
+        }
+    }
+    return std::string::npos;
+}
+
+std::vector<std::string> split_statements(const std::string& script) {
+    std::vector<std::string> statements;
+    bool in_quotes = false;
+    size_t start = 0;
+    for (size_t i = 0; i <= script.size(); ++i) {
+        if (i < script.size() && script[i] == '\'') {
+            in_quotes = !in_quotes;
+        }
+        else if (i == script.size() || (!in_quotes && script[i] == ';')) {
+            std::string statement = trim(script.substr(start, i - start));
+            if (!statement.empty()) {
+                statements.push_back(std::move(statement));
+            }
+            start = i + 1;
+        }
+    }
+    return statements;
+}
+
+std::vector<std::string> split_list(const std::string& text, const std::string& clause) {
+    std::vector<std::string> items;
+    std::istringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        item = trim(item);
+        if (item.empty()) {
+            throw std::runtime_error("Empty column name in " + clause + ".");
+        }
+        items.push_back(item);
+    }
+    if (items.empty()) {
+        throw std::runtime_error("Missing columns in " + clause + ".");
+    }
+    return items;
+}
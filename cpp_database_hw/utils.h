@@ -1,7 +1,10 @@
 #ifndef UTILS_H
 #define UTILS_H
 
+#include <cstdint>
 #include <string>
+#include <vector>
+#include "value.h"
 
 //        .
 std::string trim(const std::string& str);
@@ -9,4 +12,17 @@ std::string trim(const std::string& str);
 // ,    .
 bool is_numeric(const std::string& str);
 
+//    (FNV-1a):      ,
+//    ,   .
+uint64_t stable_hash(const Value& value);
+
+//       (  )  npos.
+size_t find_keyword(const std::string& text, const std::string& keyword, size_t from = 0);
+
+//    ; clause -      .
+std::vector<std::string> split_list(const std::string& text, const std::string& clause);
+
+//      ';'   ;   .
+std::vector<std::string> split_statements(const std::string& script);
+
 #endif // UTILS_H
@@ -0,0 +1,60 @@
+#include "value.h"
+#include <stdexcept>
+
+static_assert(sizeof(Value) == 16, "Value must stay 16 bytes.");
+
+const char* Value::type_name(Type type) {
+    switch (type) {
+    case Type::Null: return "NULL";
+    case Type::Int: return "int32";
+    case Type::Int64: return "int64";
+    case Type::Double: return "double";
+    case Type::Bool: return "bool";
+    case Type::String: return "string";
+    }
+    return "unknown";
+}
+
+void Value::throw_type_mismatch(Type expected) const {
+    throw std::runtime_error(std::string("Type mismatch: expected ") + type_name(expected) + ", got " + type_name() + ".");
+}
+
+void Value::assign_string(std::string_view value) {
+    tag = Type::String;
+    if (value.size() <= INLINE_CAPACITY) {
+        small_size = static_cast<uint8_t>(value.size());
+        if (!value.empty()) {
+            std::memcpy(bytes, value.data(), value.size());
+        }
+        return;
+    }
+    if (value.size() > UINT32_MAX) {
+        tag = Type::Null;
+        throw std::runtime_error("String value is too long.");
+    }
+    char* data = new char[value.size()];
+    std::memcpy(data, value.data(), value.size());
+    small_size = HEAP_STRING;
+    put(data);
+    put(static_cast<uint32_t>(value.size()), sizeof(char*));
+}
+
+void Value::copy_from(const Value& other) {
+    if (other.tag == Type::String && other.small_size == HEAP_STRING) {
+        assign_string(other.as_string());
+        return;
+    }
+    std::memcpy(bytes, other.bytes, sizeof(bytes));
+    small_size = other.small_size;
+    tag = other.tag;
+}
+
+Value::Type column_value_type(const std::string& column_type) {
+    if (column_type == "int32") {
+        return Value::Type::Int;
+    }
+    if (column_type == "bool") {
+        return Value::Type::Bool;
+    }
+    return Value::Type::String;
+}
@@ -0,0 +1,114 @@
+#ifndef VALUE_H
+#define VALUE_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+//  : NULL, int32, int64, double, bool  .  16 :
+//   INLINE_CAPACITY    ,  -  .
+//       std::runtime_error  .
+class Value {
+public:
+    enum class Type : uint8_t { Null, Int, Int64, Double, Bool, String };
+    static const size_t INLINE_CAPACITY = 14;
+
+    Value() = default;
+    Value(int value) : tag(Type::Int) { put(value); }
+    Value(int64_t value) : tag(Type::Int64) { put(value); }
+    Value(double value) : tag(Type::Double) { put(value); }
+    Value(bool value) : tag(Type::Bool) { bytes[0] = value ? 1 : 0; }
+    Value(std::string_view value) { assign_string(value); }
+    Value(const std::string& value) : Value(std::string_view(value)) {}
+    Value(const char* value) : Value(std::string_view(value)) {}
+
+    Value(const Value& other) { copy_from(other); }
+    Value(Value&& other) noexcept { steal(other); }
+    Value& operator=(const Value& other) {
+        if (this != &other) {
+            release();
+            copy_from(other);
+        }
+        return *this;
+    }
+    Value& operator=(Value&& other) noexcept {
+        if (this != &other) {
+            release();
+            steal(other);
+        }
+        return *this;
+    }
+    ~Value() { release(); }
+
+    Type type() const { return tag; }
+    bool has_value() const { return tag != Type::Null; }
+    bool same_type(const Value& other) const { return tag == other.tag; }
+    bool is_int() const { return tag == Type::Int; }
+    bool is_int64() const { return tag == Type::Int64; }
+    bool is_double() const { return tag == Type::Double; }
+    bool is_bool() const { return tag == Type::Bool; }
+    bool is_string() const { return tag == Type::String; }
+
+    int32_t as_int() const { expect(Type::Int); return get<int32_t>(); }
+    int64_t as_int64() const { expect(Type::Int64); return get<int64_t>(); }
+    double as_double() const { expect(Type::Double); return get<double>(); }
+    bool as_bool() const { expect(Type::Bool); return bytes[0] != 0; }
+    std::string_view as_string() const {
+        expect(Type::String);
+        if (small_size != HEAP_STRING) {
+            return std::string_view(bytes, small_size);
+        }
+        return std::string_view(get<const char*>(), get<uint32_t>(sizeof(char*)));
+    }
+
+    //       ( ).
+    size_t heap_bytes() const { return tag == Type::String && small_size == HEAP_STRING ? get<uint32_t>(sizeof(char*)) : 0; }
+
+    // "NULL", "int32", "int64", "double", "bool"  "string".
+    const char* type_name() const { return type_name(tag); }
+    static const char* type_name(Type type);
+
+private:
+    static const uint8_t HEAP_STRING = 0xFF;
+
+    //     14 ;    -   
+    alignas(8) char bytes[INLINE_CAPACITY] = {};
+    uint8_t small_size = 0;
+    Type tag = Type::Null;
+
+    template <typename T>
+    void put(T value, size_t offset = 0) { std::memcpy(bytes + offset, &value, sizeof(T)); }
+    template <typename T>
+    T get(size_t offset = 0) const {
+        T value;
+        std::memcpy(&value, bytes + offset, sizeof(T));
+        return value;
+    }
+
+    void expect(Type type) const {
+        if (tag != type) {
+            throw_type_mismatch(type);
+        }
+    }
+    [[noreturn]] void throw_type_mismatch(Type expected) const;
+    void assign_string(std::string_view value);
+    void copy_from(const Value& other);
+    void steal(Value& other) noexcept {
+        std::memcpy(bytes, other.bytes, sizeof(bytes));
+        small_size = other.small_size;
+        tag = other.tag;
+        other.tag = Type::Null;
+    }
+    void release() {
+        if (tag == Type::String && small_size == HEAP_STRING) {
+            delete[] get<char*>();
+        }
+        tag = Type::Null;
+    }
+};
+
+//         ("int32", "string", "bool").
+Value::Type column_value_type(const std::string& column_type);
+
+#endif // VALUE_H
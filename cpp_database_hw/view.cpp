@@ -0,0 +1,294 @@
+#include "view.h"
+#include <algorithm>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include "utils.h"
+
+namespace {
+
+using Rows = std::vector<std::vector<Value>>;
+
+size_t ordinal(const std::vector<std::string>& columns, const std::string& column) {
+    auto it = std::find(columns.begin(), columns.end(), column);
+    if (it == columns.end()) {
+        throw std::runtime_error("Column " + column + " not found.");
+    }
+    return static_cast<size_t>(it - columns.begin());
+}
+
+//         (  ,
+// UPDATE   )    .
+void cancel_pairs(Rows& inserted, Rows& deleted) {
+    if (inserted.empty() || deleted.empty()) {
+        return;
+    }
+    std::map<std::vector<Value>, size_t, RowLess> pending;
+    for (const auto& row : deleted) {
+        ++pending[row];
+    }
+    Rows kept;
+    for (auto& row : inserted) {
+        auto it = pending.find(row);
+        if (it != pending.end() && it->second > 0) {
+            --it->second;
+        }
+        else {
+            kept.push_back(std::move(row));
+        }
+    }
+    inserted = std::move(kept);
+    deleted.clear();
+    for (auto& [row, count] : pending) {
+        deleted.insert(deleted.end(), count, row);
+    }
+}
+
+//    ;   UPDATE,    int32 - .
+int32_t add_checked(int32_t value, int64_t delta, const ViewAggregate& aggregate) {
+    int64_t result = value + delta;
+    if (result < std::numeric_limits<int32_t>::min() || result > std::numeric_limits<int32_t>::max()) {
+        std::string name = aggregate.kind == ViewAggregate::Kind::Sum ? "SUM(" + aggregate.column + ")" : "COUNT(*)";
+        throw std::runtime_error("Integer overflow in " + name + " of materialized view.");
+    }
+    return static_cast<int32_t>(result);
+}
+
+void apply_aggregates(Table& view, const ViewDefinition& definition, const Table& base,
+    const Rows& inserted, const Rows& deleted) {
+    const auto& base_columns = base.get_columns();
+    const auto& view_columns = view.get_columns();
+    std::vector<size_t> key_source, key_target;
+    for (const auto& column : definition.group_by) {
+        key_source.push_back(ordinal(base_columns, column));
+        key_target.push_back(ordinal(view_columns, column));
+    }
+    std::vector<size_t> sum_source, aggregate_target;
+    for (const auto& aggregate : definition.aggregates) {
+        sum_source.push_back(aggregate.kind == ViewAggregate::Kind::Sum ? ordinal(base_columns, aggregate.column) : 0);
+        aggregate_target.push_back(ordinal(view_columns, aggregate.output));
+    }
+
+    //     
+    std::map<std::vector<Value>, std::vector<int64_t>, RowLess> deltas;
+    if (definition.group_by.empty()) {
+        //  GROUP BY -  ,    
+        deltas[{}].assign(definition.aggregates.size(), 0);
+    }
+    auto accumulate = [&](const Rows& rows, int64_t sign) {
+        for (const auto& row : rows) {
+            std::vector<Value> key;
+            for (size_t source : key_source) {
+                key.push_back(row[source]);
+            }
+            auto& delta = deltas[key];
+            delta.resize(definition.aggregates.size());
+            for (size_t a = 0; a < definition.aggregates.size(); ++a) {
+                if (definition.aggregates[a].kind == ViewAggregate::Kind::Count) {
+                    delta[a] += sign;
+                }
+                else if (row[sum_source[a]].is_int()) {
+                    delta[a] += sign * row[sum_source[a]].as_int();
+                }
+            }
+        }
+        };
+    accumulate(inserted, 1);
+    accumulate(deleted, -1);
+
+    //          
+    Rows old_rows, new_rows;
+    for (auto it = deltas.begin(); it != deltas.end();) {
+        Rows current = view.rows_with_key(key_target, it->first);
+        if (current.empty()) {
+            ++it;
+            continue;
+        }
+        std::vector<Value>& row = current.front();
+        std::vector<Value> updated = row;
+        for (size_t a = 0; a < definition.aggregates.size(); ++a) {
+            updated[aggregate_target[a]] = add_checked(row[aggregate_target[a]].as_int(), it->second[a], definition.aggregates[a]);
+        }
+        old_rows.push_back(std::move(row));
+        new_rows.push_back(std::move(updated));
+        it = deltas.erase(it);
+    }
+    for (auto& [key, delta] : deltas) {
+        std::vector<Value> row(view_columns.size());
+        for (size_t k = 0; k < key.size(); ++k) {
+            row[key_target[k]] = key[k];
+        }
+        for (size_t a = 0; a < definition.aggregates.size(); ++a) {
+            row[aggregate_target[a]] = add_checked(0, delta[a], definition.aggregates[a]);
+        }
+        new_rows.push_back(std::move(row));
+    }
+
+    //   
+    if (!definition.group_by.empty()) {
+        size_t count = ordinal(view_columns, "count");
+        new_rows.erase(std::remove_if(new_rows.begin(), new_rows.end(),
+            [count](const std::vector<Value>& row) { return row[count].as_int() <= 0; }), new_rows.end());
+    }
+    view.remove_rows(old_rows);
+    view.insert_batch(std::move(new_rows));
+}
+
+//        :  
+//  GROUP BY -   ,   -  id   .  
+//   ,       .
+void index_view(Table& view, const ViewDefinition& definition) {
+    std::vector<std::string> key;
+    if (definition.is_aggregate()) {
+        key = definition.group_by;
+    }
+    else {
+        const auto& columns = view.get_columns();
+        key.push_back(std::find(columns.begin(), columns.end(), "id") != columns.end() ? "id" : columns.front());
+    }
+    if (!key.empty() && !view.has_composite_index(key)) {
+        view.create_composite_index(key);
+    }
+}
+
+}
+
+ViewDefinition parse_view_query(const std::string& query) {
+    std::istringstream stream(query);
+    std::string command, items, from_kw, rest;
+    ViewDefinition definition;
+    stream >> command >> items >> from_kw >> definition.base_table;
+    if (command != "SELECT" || from_kw != "FROM" || definition.base_table.empty()) {
+        throw std::runtime_error("Syntax error: Expected 'SELECT <columns> FROM <table>' in materialized view.");
+    }
+    std::getline(stream, rest);
+    rest = trim(rest);
+    if (find_keyword(rest, "ORDER") != std::string::npos || find_keyword(rest, "LIMIT") != std::string::npos) {
+        throw std::runtime_error("ORDER BY and LIMIT are not supported in materialized views.");
+    }
+
+    size_t group_pos = find_keyword(rest, "GROUP");
+    std::string where_part = trim(rest.substr(0, group_pos));
+    if (!where_part.empty()) {
+        if (find_keyword(where_part, "WHERE") != 0) {
+            throw std::runtime_error("Syntax error: Unexpected '" + where_part + "' in materialized view.");
+        }
+        definition.condition = trim(where_part.substr(5));
+        if (definition.condition.empty()) {
+            throw std::runtime_error("Missing or empty condition in materialized view.");
+        }
+    }
+    if (group_pos != std::string::npos) {
+        std::istringstream group_stream(rest.substr(group_pos));
+        std::string group_kw, by_kw, columns;
+        group_stream >> group_kw >> by_kw;
+        if (by_kw != "BY") throw std::runtime_error("Syntax error: Expected 'BY' after GROUP.");
+        std::getline(group_stream, columns);
+        definition.group_by = split_list(columns, "GROUP BY");
+    }
+
+    if (items != "*") {
+        for (const auto& item : split_list(items, "SELECT")) {
+            if (item == "COUNT(*)") {
+                definition.aggregates.push_back({ ViewAggregate::Kind::Count, "", "count" });
+            }
+            else if (item.size() > 5 && item.compare(0, 4, "SUM(") == 0 && item.back() == ')') {
+                std::string column = trim(item.substr(4, item.size() - 5));
+                definition.aggregates.push_back({ ViewAggregate::Kind::Sum, column, "sum_" + column });
+            }
+            else if (item.find('(') != std::string::npos) {
+                throw std::runtime_error("Unsupported aggregate in materialized view: " + item + ". Expected COUNT(*) or SUM(column).");
+            }
+            else {
+                definition.columns.push_back(item);
+            }
+        }
+    }
+
+    if (definition.is_aggregate()) {
+        if (items == "*") {
+            throw std::runtime_error("SELECT * cannot be combined with GROUP BY in materialized view.");
+        }
+        for (const auto& column : definition.columns) {
+            if (std::find(definition.group_by.begin(), definition.group_by.end(), column) == definition.group_by.end()) {
+                throw std::runtime_error("Column " + column + " must appear in GROUP BY of materialized view.");
+            }
+        }
+        bool has_count = std::any_of(definition.aggregates.begin(), definition.aggregates.end(),
+            [](const ViewAggregate& aggregate) { return aggregate.kind == ViewAggregate::Kind::Count; });
+        if (!has_count && !definition.group_by.empty()) {
+            definition.aggregates.push_back({ ViewAggregate::Kind::Count, "", "count" });
+        }
+    }
+    return definition;
+}
+
+std::map<std::string, std::string> view_schema(const ViewDefinition& definition, const Table& base) {
+    //   ,      
+    base.filter_rows(definition.condition, {});
+
+    std::map<std::string, std::string> schema;
+    auto add_column = [&](const std::string& name, const std::string& type) {
+        if (!schema.emplace(name, type).second) {
+            throw std::runtime_error("Duplicate column " + name + " in materialized view.");
+        }
+        };
+    if (!definition.is_aggregate()) {
+        const auto& columns = definition.columns.empty() ? base.get_columns() : definition.columns;
+        for (const auto& column : columns) {
+            add_column(column, base.get_column_type(column));
+        }
+        return schema;
+    }
+    for (const auto& column : definition.group_by) {
+        add_column(column, base.get_column_type(column));
+    }
+    for (const auto& aggregate : definition.aggregates) {
+        if (aggregate.kind == ViewAggregate::Kind::Sum && base.get_column_type(aggregate.column) != "int32") {
+            throw std::runtime_error("SUM expects an int32 column, got " + aggregate.column + ".");
+        }
+        add_column(aggregate.output, "int32");
+    }
+    return schema;
+}
+
+void apply_view_changes(Table& view, const ViewDefinition& definition, const Table& base, const RowChanges& changes) {
+    index_view(view, definition);
+    Rows inserted = base.filter_rows(definition.condition, changes.inserted);
+    Rows deleted = base.filter_rows(definition.condition, changes.deleted);
+    cancel_pairs(inserted, deleted);
+
+    if (definition.is_aggregate()) {
+        if (!inserted.empty() || !deleted.empty() || (definition.group_by.empty() && view.row_count() == 0)) {
+            apply_aggregates(view, definition, base, inserted, deleted);
+        }
+        return;
+    }
+
+    //   -        
+    std::vector<size_t> source;
+    for (const auto& column : view.get_columns()) {
+        source.push_back(ordinal(base.get_columns(), column));
+    }
+    auto project = [&source](const Rows& rows) {
+        Rows result;
+        result.reserve(rows.size());
+        for (const auto& row : rows) {
+            std::vector<Value> projected;
+            projected.reserve(source.size());
+            for (size_t column : source) {
+                projected.push_back(row[column]);
+            }
+            result.push_back(std::move(projected));
+        }
+        return result;
+        };
+    if (!deleted.empty()) {
+        view.remove_rows(project(deleted));
+    }
+    if (!inserted.empty()) {
+        view.insert_batch(project(inserted));
+    }
+}
@@ -0,0 +1,43 @@
+#ifndef VIEW_H
+#define VIEW_H
+
+#include <map>
+#include <string>
+#include <vector>
+#include "table.h"
+
+//   : COUNT(*)  SUM( int32).
+struct ViewAggregate {
+    enum class Kind { Count, Sum };
+
+    Kind kind = Kind::Count;
+    std::string column;     //  
+    std::string output;     //  : "count"  "sum_<>"
+};
+
+//   :
+// SELECT <  > FROM <> [WHERE <>] [GROUP BY <>].
+struct ViewDefinition {
+    std::string base_table;
+    std::string condition = "true";
+    std::vector<std::string> columns;       //    ;  - 
+    std::vector<std::string> group_by;
+    std::vector<ViewAggregate> aggregates;
+
+    //        ; COUNT(*)    ,
+    //  ,   .
+    bool is_aggregate() const { return !aggregates.empty() || !group_by.empty(); }
+};
+
+ViewDefinition parse_view_query(const std::string& query);
+
+//    ;     .
+std::map<std::string, std::string> view_schema(const ViewDefinition& definition, const Table& base);
+
+//        . 
+//      ,     ;  
+//    ,    . SUM   int32:
+//      - ,    UPDATE; NULL    .
+void apply_view_changes(Table& view, const ViewDefinition& definition, const Table& base, const RowChanges& changes);
+
+#endif // VIEW_H
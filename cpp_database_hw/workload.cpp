@@ -0,0 +1,342 @@
+#include "workload.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cmath>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include "database.h"
+#include "result_cache.h"
+#include "utils.h"
+
+static const char RECORD_MAGIC[] = "WL1";
+
+static char kind_code(WorkloadEntry::Kind kind) {
+    switch (kind) {
+    case WorkloadEntry::Kind::Batch: return 'B';
+    case WorkloadEntry::Kind::Transaction: return 'T';
+    default: return 'S';
+    }
+}
+
+WorkloadRecorder::WorkloadRecorder(const std::string& path)
+    : path(path), started(std::chrono::steady_clock::now()), out(path, std::ios::binary | std::ios::trunc) {
+    if (!out.is_open()) {
+        throw std::runtime_error("Failed to open workload log: " + path);
+    }
+}
+
+WorkloadRecorder::~WorkloadRecorder() {
+    out.flush();
+}
+
+void WorkloadRecorder::record(const WorkloadEntry& entry) {
+    //   ,      
+    std::ostringstream text;
+    text << RECORD_MAGIC << ' ' << entry.offset.count() << ' ' << entry.latency.count() << ' ' << entry.rows << ' '
+        << (entry.ok ? 0 : 1) << ' ' << kind_code(entry.kind) << ' ' << entry.statement.size() << '\n'
+        << entry.statement << '\n';
+    std::lock_guard<std::mutex> lock(mutex);
+    out << text.str();
+    if (!out) {
+        throw std::runtime_error("Failed to write workload log: " + path);
+    }
+    ++entries;
+}
+
+std::chrono::microseconds WorkloadRecorder::elapsed(std::chrono::steady_clock::time_point time) const {
+    return std::chrono::duration_cast<std::chrono::microseconds>(time - started);
+}
+
+size_t WorkloadRecorder::entry_count() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return entries;
+}
+
+CaptureScope::CaptureScope(std::shared_ptr<WorkloadRecorder> recorder, WorkloadEntry::Kind kind, const std::string& statement)
+    : recorder(std::move(recorder)) {
+    if (!this->recorder) {
+        return;
+    }
+    entry.kind = kind;
+    entry.statement = statement;
+    entry.ok = false;
+    previous_rows = current_rows_affected;
+    current_rows_affected = &entry.rows;
+    started = std::chrono::steady_clock::now();
+}
+
+CaptureScope::~CaptureScope() {
+    if (!recorder) {
+        return;
+    }
+    auto finished = std::chrono::steady_clock::now();
+    current_rows_affected = previous_rows;
+    entry.offset = recorder->elapsed(started);
+    entry.latency = std::chrono::duration_cast<std::chrono::microseconds>(finished - started);
+    try {
+        recorder->record(entry);
+    }
+    catch (const std::exception&) {
+        //        
+    }
+}
+
+std::vector<WorkloadEntry> read_workload(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        throw std::runtime_error("Failed to open workload log: " + path);
+    }
+    std::vector<WorkloadEntry> entries;
+    std::string header;
+    while (std::getline(in, header)) {
+        std::istringstream fields(header);
+        std::string magic;
+        int64_t offset = 0, latency = 0;
+        int failed = 0;
+        char kind = 0;
+        size_t size = 0;
+        WorkloadEntry entry;
+        if (!(fields >> magic >> offset >> latency >> entry.rows >> failed >> kind >> size) || magic != RECORD_MAGIC) {
+            throw std::runtime_error("Corrupted workload record " + std::to_string(entries.size() + 1) + ".");
+        }
+        entry.offset = std::chrono::microseconds(offset);
+        entry.latency = std::chrono::microseconds(latency);
+        entry.ok = (failed == 0);
+        entry.kind = (kind == 'B') ? WorkloadEntry::Kind::Batch
+            : (kind == 'T') ? WorkloadEntry::Kind::Transaction : WorkloadEntry::Kind::Statement;
+        entry.statement.resize(size);
+        if (!in.read(entry.statement.data(), static_cast<std::streamsize>(size)) || in.get() != '\n') {
+            //       
+            break;
+        }
+        entries.push_back(std::move(entry));
+    }
+    //     ,  -   
+    std::stable_sort(entries.begin(), entries.end(), [](const WorkloadEntry& a, const WorkloadEntry& b) {
+        return a.offset < b.offset;
+        });
+    return entries;
+}
+
+static bool is_word_char(char c) {
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+static std::string command_shape(const std::string& statement) {
+    std::string text = normalize_statement(statement);
+    std::string result;
+    size_t i = 0;
+    while (i < text.size()) {
+        char c = text[i];
+        if (c == '\'') {
+            //  ; ''  -  
+            ++i;
+            while (i < text.size()) {
+                if (text[i] == '\'' && (i + 1 >= text.size() || text[i + 1] != '\'')) {
+                    break;
+                }
+                i += (text[i] == '\'') ? 2 : 1;
+            }
+            ++i;
+            result += '?';
+            continue;
+        }
+        if (is_word_char(c)) {
+            size_t end = i;
+            while (end < text.size() && is_word_char(text[end])) {
+                ++end;
+            }
+            std::string word = text.substr(i, end - i);
+            bool number = std::isdigit(static_cast<unsigned char>(word[0])) != 0;
+            result += (number || word == "true" || word == "false") ? "?" : word;
+            i = end;
+            continue;
+        }
+        if (c == '-' && i + 1 < text.size() && std::isdigit(static_cast<unsigned char>(text[i + 1]))) {
+            //  ,     
+            size_t prev = result.find_last_not_of(' ');
+            if (prev == std::string::npos || !(is_word_char(result[prev]) || result[prev] == '?' || result[prev] == ')')) {
+                ++i;
+                continue;
+            }
+        }
+        result += c;
+        ++i;
+    }
+    return result;
+}
+
+std::string statement_shape(const WorkloadEntry& entry) {
+    if (entry.kind != WorkloadEntry::Kind::Batch) {
+        return command_shape(entry.statement);
+    }
+    std::string result, last;
+    for (const auto& statement : split_statements(entry.statement)) {
+        std::string shape = command_shape(statement);
+        if (shape != last) {
+            result += (result.empty() ? "" : "; ") + shape;
+            last = shape;
+        }
+    }
+    return result;
+}
+
+//    ;    .
+static uint64_t replay_entry(Database& db, const WorkloadEntry& entry) {
+    uint64_t rows = 0;
+    uint64_t* previous = current_rows_affected;
+    current_rows_affected = &rows;
+    try {
+        if (entry.kind == WorkloadEntry::Kind::Batch) {
+            db.execute_batch(entry.statement);
+        }
+        else if (entry.kind == WorkloadEntry::Kind::Transaction) {
+            if (entry.statement == "BEGIN") {
+                db.begin_transaction();
+            }
+            else if (entry.statement == "COMMIT") {
+                db.commit_transaction();
+            }
+            else {
+                db.rollback_transaction();
+            }
+        }
+        else {
+            db.execute(entry.statement);
+        }
+    }
+    catch (...) {
+        current_rows_affected = previous;
+        throw;
+    }
+    current_rows_affected = previous;
+    return rows;
+}
+
+//  : ,     p .
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0.0;
+    }
+    size_t rank = static_cast<size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::min(sorted.size(), std::max<size_t>(rank, 1)) - 1];
+}
+
+ReplayReport replay_workload(Database& db, const std::vector<WorkloadEntry>& entries, const ReplayOptions& options) {
+    if (options.speed <= 0.0) {
+        throw std::runtime_error("Replay speed must be positive.");
+    }
+    struct Outcome {
+        double milliseconds = 0.0;
+        bool ok = true;
+        uint64_t rows = 0;
+    };
+    std::vector<Outcome> outcomes(entries.size());
+    std::atomic<size_t> next{ 0 };
+    auto started = std::chrono::steady_clock::now();
+    auto first_offset = entries.empty() ? std::chrono::microseconds(0) : entries.front().offset;
+
+    auto worker = [&]() {
+        while (true) {
+            size_t i = next++;
+            if (i >= entries.size()) {
+                break;
+            }
+            const WorkloadEntry& entry = entries[i];
+            if (options.original_pacing) {
+                auto delay = std::chrono::duration_cast<std::chrono::microseconds>(
+                    (entry.offset - first_offset) / options.speed);
+                std::this_thread::sleep_until(started + delay);
+            }
+            auto call_started = std::chrono::steady_clock::now();
+            Outcome& outcome = outcomes[i];
+            try {
+                outcome.rows = replay_entry(db, entry);
+            }
+            catch (const std::exception&) {
+                outcome.ok = false;
+            }
+            outcome.milliseconds = std::chrono::duration<double, std::milli>(
+                std::chrono::steady_clock::now() - call_started).count();
+        }
+        };
+
+    size_t thread_count = std::max<size_t>(1, std::min(options.concurrency, entries.size()));
+    if (thread_count == 1) {
+        worker();
+    }
+    else {
+        std::vector<std::thread> threads;
+        for (size_t t = 0; t < thread_count; ++t) {
+            threads.emplace_back(worker);
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    ReplayReport report;
+    report.statements = entries.size();
+    report.duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - started);
+
+    struct ShapeSamples {
+        ShapeReport summary;
+        std::vector<double> replayed;
+        std::vector<double> captured;
+        double total = 0.0;
+    };
+    std::map<std::string, ShapeSamples> by_shape;
+    for (size_t i = 0; i < entries.size(); ++i) {
+        std::string shape = statement_shape(entries[i]);
+        ShapeSamples& samples = by_shape[shape];
+        samples.summary.shape = shape;
+        ++samples.summary.count;
+        if (outcomes[i].ok != entries[i].ok) {
+            ++samples.summary.status_mismatches;
+        }
+        else if (outcomes[i].ok && outcomes[i].rows != entries[i].rows) {
+            ++samples.summary.row_mismatches;
+        }
+        samples.replayed.push_back(outcomes[i].milliseconds);
+        samples.captured.push_back(entries[i].latency.count() / 1000.0);
+        samples.total += outcomes[i].milliseconds;
+    }
+
+    std::vector<std::pair<double, ShapeReport>> ranked;
+    for (auto& [shape, samples] : by_shape) {
+        std::sort(samples.replayed.begin(), samples.replayed.end());
+        std::sort(samples.captured.begin(), samples.captured.end());
+        ShapeReport& summary = samples.summary;
+        summary.p50 = percentile(samples.replayed, 0.50);
+        summary.p95 = percentile(samples.replayed, 0.95);
+        summary.p99 = percentile(samples.replayed, 0.99);
+        summary.max = samples.replayed.back();
+        summary.captured_p50 = percentile(samples.captured, 0.50);
+        summary.captured_p99 = percentile(samples.captured, 0.99);
+        ranked.emplace_back(samples.total, std::move(summary));
+    }
+    std::stable_sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+    for (auto& [total, summary] : ranked) {
+        report.shapes.push_back(std::move(summary));
+    }
+    return report;
+}
+
+std::string format_replay_report(const ReplayReport& report) {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "statements: " << report.statements << ", duration: " << report.duration.count() << " ms\n";
+    for (const auto& shape : report.shapes) {
+        out << "shape: " << shape.shape << "\n"
+            << "  count: " << shape.count << ", status mismatches: " << shape.status_mismatches
+            << ", row count mismatches: " << shape.row_mismatches << "\n"
+            << "  latency ms p50: " << shape.p50 << ", p95: " << shape.p95 << ", p99: " << shape.p99
+            << ", max: " << shape.max << " (captured p50: " << shape.captured_p50
+            << ", p99: " << shape.captured_p99 << ")\n";
+    }
+    return out.str();
+}
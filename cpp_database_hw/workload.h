@@ -0,0 +1,108 @@
+#ifndef WORKLOAD_H
+#define WORKLOAD_H
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class Database; //  
+
+// ,    .
+struct WorkloadEntry {
+    enum class Kind { Statement, Batch, Transaction };
+
+    Kind kind = Kind::Statement;        // execute, execute_batch  BEGIN/COMMIT/ROLLBACK
+    std::chrono::microseconds offset{ 0 };  //     
+    std::chrono::microseconds latency{ 0 };
+    uint64_t rows = 0;                  //    SELECT   
+    bool ok = true;                     // false -   
+    std::string statement;
+};
+
+//  :       ,
+//   WL1 <, > <, > <> <0|1 - > <S|B|T> <>\n<>\n
+class WorkloadRecorder {
+public:
+    //    (  ).
+    explicit WorkloadRecorder(const std::string& path);
+    ~WorkloadRecorder();
+
+    void record(const WorkloadEntry& entry);
+    std::chrono::microseconds elapsed(std::chrono::steady_clock::time_point time) const;
+    size_t entry_count() const;
+    const std::string& get_path() const { return path; }
+
+private:
+    std::string path;
+    std::chrono::steady_clock::time_point started;
+    mutable std::mutex mutex;
+    std::ofstream out;
+    size_t entries = 0;
+};
+
+//  ,     (nullptr -   ).
+inline thread_local uint64_t* current_rows_affected = nullptr;
+
+inline void note_rows_affected(uint64_t rows) {
+    if (current_rows_affected) {
+        *current_rows_affected += rows;
+    }
+}
+
+//            .
+//     .   finish()   .
+class CaptureScope {
+public:
+    CaptureScope(std::shared_ptr<WorkloadRecorder> recorder, WorkloadEntry::Kind kind, const std::string& statement);
+    ~CaptureScope();
+    CaptureScope(const CaptureScope&) = delete;
+    CaptureScope& operator=(const CaptureScope&) = delete;
+
+    bool active() const { return recorder != nullptr; }
+    void finish() { entry.ok = true; }
+
+private:
+    std::shared_ptr<WorkloadRecorder> recorder;
+    WorkloadEntry entry;
+    std::chrono::steady_clock::time_point started;
+    uint64_t* previous_rows = nullptr;
+};
+
+std::vector<WorkloadEntry> read_workload(const std::string& path);
+
+//  :    '?',   .
+//   -    "; " (  -  ).
+std::string statement_shape(const WorkloadEntry& entry);
+
+struct ReplayOptions {
+    bool original_pacing = true;    // false -  ,   
+    double speed = 1.0;             //    
+    size_t concurrency = 1;         // ,  
+};
+
+//       ()     .
+struct ShapeReport {
+    std::string shape;
+    size_t count = 0;
+    size_t status_mismatches = 0;   //  ,    (  )
+    size_t row_mismatches = 0;      //     
+    double p50 = 0, p95 = 0, p99 = 0, max = 0;
+    double captured_p50 = 0, captured_p99 = 0;
+};
+
+struct ReplayReport {
+    size_t statements = 0;
+    std::chrono::milliseconds duration{ 0 };
+    std::vector<ShapeReport> shapes;   //    
+};
+
+//      .  concurrency > 1  
+//  ,    ,     .
+ReplayReport replay_workload(Database& db, const std::vector<WorkloadEntry>& entries, const ReplayOptions& options = {});
+std::string format_replay_report(const ReplayReport& report);
+
+#endif // WORKLOAD_H
@@ -0,0 +1,324 @@
+#include "zone_map.h"
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+#include "memory_usage.h"
+#include "utils.h"
+
+//  : 10   7      1%  .
+//          min/max.
+static const size_t BLOOM_MIN_DISTINCT = 32;
+static const size_t BLOOM_BITS_PER_VALUE = 10;
+static const int BLOOM_HASHES = 7;
+
+namespace {
+
+enum class ZoneTag : uint8_t { Int = 1, String = 2, Bool = 3 };
+
+//     :      .
+uint64_t mix_hash(uint64_t hash) {
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+void bloom_add(std::vector<uint64_t>& bloom, uint64_t hash) {
+    uint64_t bits = bloom.size() * 64;
+    uint64_t step = mix_hash(hash) | 1;
+    for (int i = 0; i < BLOOM_HASHES; ++i) {
+        uint64_t bit = (hash + i * step) % bits;
+        bloom[bit / 64] |= 1ull << (bit % 64);
+    }
+}
+
+bool bloom_may_contain(const std::vector<uint64_t>& bloom, uint64_t hash) {
+    uint64_t bits = bloom.size() * 64;
+    uint64_t step = mix_hash(hash) | 1;
+    for (int i = 0; i < BLOOM_HASHES; ++i) {
+        uint64_t bit = (hash + i * step) % bits;
+        if (!(bloom[bit / 64] & (1ull << (bit % 64)))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void widen_zone(ColumnZone& zone, const Value& value) {
+    if (!value.has_value()) {
+        zone.has_nulls = true;
+        return;
+    }
+    if (!zone.min_value.has_value()) {
+        zone.min_value = value;
+        zone.max_value = value;
+    }
+    else if (!zone.min_value.same_type(value)) {
+        zone.mixed_types = true;
+        return;
+    }
+    else if (compare_values(value, zone.min_value) < 0) {
+        zone.min_value = value;
+    }
+    else if (compare_values(value, zone.max_value) > 0) {
+        zone.max_value = value;
+    }
+    if (!zone.bloom.empty()) {
+        bloom_add(zone.bloom, stable_hash(value));
+    }
+}
+
+bool compare_may_match(const ColumnZone& zone, const Condition& condition) {
+    if (zone.mixed_types) {
+        return true;
+    }
+    const Value& value = condition.value;
+    if (!value.has_value()) {
+        // "col=NULL"   , "col!=NULL" - 
+        return condition.op == CompareOp::Eq ? zone.has_nulls : zone.min_value.has_value();
+    }
+    if (!zone.min_value.has_value()) {
+        return false;
+    }
+
+    if (condition.op == CompareOp::Like) {
+        if (!value.is_string()) {
+            return true;
+        }
+        if (!zone.min_value.is_string()) {
+            return false;
+        }
+        //    p    p     p
+        std::string prefix = like_prefix(value.as_string());
+        std::string_view min = zone.min_value.as_string(), max = zone.max_value.as_string();
+        return prefix.empty() || (max >= prefix && min.compare(0, prefix.size(), prefix) <= 0);
+    }
+
+    //         
+    if (!zone.min_value.same_type(value)) {
+        return false;
+    }
+    int low = compare_values(value, zone.min_value);
+    int high = compare_values(value, zone.max_value);
+    switch (condition.op) {
+    case CompareOp::Eq:
+        return low >= 0 && high <= 0 && (zone.bloom.empty() || bloom_may_contain(zone.bloom, stable_hash(value)));
+    case CompareOp::Ne: return !(low == 0 && high == 0);
+    case CompareOp::Lt: return low > 0;
+    case CompareOp::Le: return low >= 0;
+    case CompareOp::Gt: return high < 0;
+    case CompareOp::Ge: return high <= 0;
+    case CompareOp::Like: break;
+    }
+    return true;
+}
+
+bool block_may_match(const BlockZone& block, const Condition& condition, const std::vector<std::string>& columns) {
+    switch (condition.kind) {
+    case Condition::Kind::Constant:
+        return condition.constant;
+    case Condition::Kind::Not:
+        return true;
+    case Condition::Kind::And:
+        for (const auto& child : condition.children) {
+            if (!block_may_match(block, child, columns)) {
+                return false;
+            }
+        }
+        return true;
+    case Condition::Kind::Or:
+        for (const auto& child : condition.children) {
+            if (block_may_match(block, child, columns)) {
+                return true;
+            }
+        }
+        return false;
+    case Condition::Kind::Compare:
+        break;
+    }
+    //  :    
+    auto it = std::find(columns.begin(), columns.end(), condition.column);
+    if (it == columns.end()) {
+        return true;
+    }
+    return compare_may_match(block.columns[it - columns.begin()], condition);
+}
+
+void put_zone_value(ByteWriter& out, const Value& value) {
+    if (value.is_int()) {
+        out.put_byte(static_cast<uint8_t>(ZoneTag::Int));
+        out.put_signed(value.as_int());
+    }
+    else if (value.is_string()) {
+        out.put_byte(static_cast<uint8_t>(ZoneTag::String));
+        out.put_string(value.as_string());
+    }
+    else {
+        out.put_byte(static_cast<uint8_t>(ZoneTag::Bool));
+        out.put_byte(value.as_bool() ? 1 : 0);
+    }
+}
+
+Value get_zone_value(ByteReader& in) {
+    switch (static_cast<ZoneTag>(in.get_byte())) {
+    case ZoneTag::Int: return static_cast<int>(in.get_signed());
+    case ZoneTag::String: return in.get_string();
+    case ZoneTag::Bool: return in.get_byte() != 0;
+    }
+    throw std::runtime_error("Corrupted zone map.");
+}
+
+}
+
+void ZoneMap::rebuild(const RowStore& rows, size_t first_row) {
+    size_t block = std::min({ first_row, rows.size(), covered_rows }) / BLOCK_ROWS;
+    blocks.resize(std::min(block, blocks.size()));
+    covered_rows = blocks.size() * BLOCK_ROWS;
+    if (blocks.empty()) {
+        widened = false;
+    }
+    append(rows, covered_rows);
+}
+
+void ZoneMap::append(const RowStore& rows, size_t first_row) {
+    if (first_row != covered_rows) {
+        rebuild(rows, std::min(first_row, covered_rows));
+        return;
+    }
+    for (size_t row = first_row; row < rows.size(); ++row) {
+        size_t block = row / BLOCK_ROWS;
+        if (block == blocks.size()) {
+            blocks.push_back({ std::vector<ColumnZone>(rows[row].size()) });
+        }
+        for (size_t c = 0; c < rows[row].size(); ++c) {
+            widen_zone(blocks[block].columns[c], rows[row][c]);
+        }
+        if ((row + 1) % BLOCK_ROWS == 0) {
+            seal(rows, block);
+        }
+    }
+    covered_rows = rows.size();
+}
+
+void ZoneMap::seal(const RowStore& rows, size_t block) {
+    size_t first = block * BLOCK_ROWS;
+    BlockZone& zone = blocks[block];
+    for (size_t c = 0; c < zone.columns.size(); ++c) {
+        ColumnZone& column = zone.columns[c];
+        if (column.mixed_types || !column.min_value.has_value() || column.min_value.is_bool()) {
+            continue;
+        }
+        std::unordered_set<uint64_t> hashes;
+        for (size_t row = first; row < first + BLOCK_ROWS; ++row) {
+            if (rows[row][c].has_value()) {
+                hashes.insert(stable_hash(rows[row][c]));
+            }
+        }
+        if (hashes.size() < BLOOM_MIN_DISTINCT) {
+            continue;
+        }
+        column.bloom.assign((hashes.size() * BLOOM_BITS_PER_VALUE + 63) / 64, 0);
+        for (uint64_t hash : hashes) {
+            bloom_add(column.bloom, hash);
+        }
+    }
+}
+
+size_t ZoneMap::memory_bytes() const {
+    size_t bytes = vector_bytes(blocks);
+    for (const auto& block : blocks) {
+        bytes += vector_bytes(block.columns);
+        for (const auto& zone : block.columns) {
+            bytes += vector_bytes(zone.bloom) + zone.min_value.heap_bytes() + zone.max_value.heap_bytes();
+        }
+    }
+    return bytes;
+}
+
+void ZoneMap::widen(size_t row, size_t column, const Value& value) {
+    size_t block = row / BLOCK_ROWS;
+    if (block < blocks.size()) {
+        widen_zone(blocks[block].columns[column], value);
+        widened = true;
+    }
+}
+
+std::vector<bool> ZoneMap::candidate_blocks(const Condition& condition, const std::vector<std::string>& columns) const {
+    std::vector<bool> result(blocks.size());
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        result[b] = block_may_match(blocks[b], condition, columns);
+    }
+    return result;
+}
+
+void ZoneMap::save(ByteWriter& out) const {
+    out.put_varint(BLOCK_ROWS);
+    out.put_varint(covered_rows);
+    out.put_varint(blocks.size());
+    for (const auto& block : blocks) {
+        out.put_varint(block.columns.size());
+        for (const auto& column : block.columns) {
+            bool has_range = column.min_value.has_value();
+            out.put_byte(static_cast<uint8_t>((column.has_nulls ? 1 : 0) | (column.mixed_types ? 2 : 0) | (has_range ? 4 : 0)));
+            if (has_range) {
+                put_zone_value(out, column.min_value);
+                put_zone_value(out, column.max_value);
+            }
+            out.put_varint(column.bloom.size());
+            for (uint64_t word : column.bloom) {
+                std::string bytes(8, '\0');
+                for (int i = 0; i < 8; ++i) {
+                    bytes[i] = static_cast<char>((word >> (8 * i)) & 0xFF);
+                }
+                out.put_bytes(bytes);
+            }
+        }
+    }
+}
+
+bool ZoneMap::load(ByteReader& in, size_t row_count, size_t column_count) {
+    size_t block_rows = in.get_varint();
+    size_t rows_covered = in.get_varint();
+    size_t block_total = in.get_varint();
+    std::vector<BlockZone> loaded(block_total);
+    for (auto& block : loaded) {
+        size_t columns = in.get_varint();
+        if (columns > column_count) {
+            throw std::runtime_error("Corrupted zone map.");
+        }
+        block.columns.resize(columns);
+        for (auto& column : block.columns) {
+            uint8_t flags = in.get_byte();
+            column.has_nulls = (flags & 1) != 0;
+            column.mixed_types = (flags & 2) != 0;
+            if (flags & 4) {
+                column.min_value = get_zone_value(in);
+                column.max_value = get_zone_value(in);
+            }
+            column.bloom.resize(in.get_varint());
+            for (auto& word : column.bloom) {
+                std::string bytes = in.get_bytes(8);
+                word = 0;
+                for (int i = 0; i < 8; ++i) {
+                    word |= static_cast<uint64_t>(static_cast<unsigned char>(bytes[i])) << (8 * i);
+                }
+            }
+        }
+    }
+
+    //           
+    bool matches = block_rows == BLOCK_ROWS && rows_covered == row_count &&
+        block_total == (row_count + BLOCK_ROWS - 1) / BLOCK_ROWS;
+    for (const auto& block : loaded) {
+        matches = matches && block.columns.size() == column_count;
+    }
+    if (!matches) {
+        return false;
+    }
+    blocks = std::move(loaded);
+    covered_rows = rows_covered;
+    widened = false;
+    return true;
+}
@@ -0,0 +1,59 @@
+#ifndef ZONE_MAP_H
+#define ZONE_MAP_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "encoding.h"
+#include "planner.h"
+#include "row_store.h"
+#include "value.h"
+
+//      .     
+//  ( UPDATE),    :    .
+struct ColumnZone {
+    Value min_value;             // ,      
+    Value max_value;
+    bool has_nulls = false;
+    bool mixed_types = false;       //   :   
+    std::vector<uint64_t> bloom;    //    ; ,   
+};
+
+struct BlockZone {
+    std::vector<ColumnZone> columns;
+};
+
+//      (min/max, NULL      ).
+//   ,          .
+class ZoneMap {
+public:
+    static const size_t BLOCK_ROWS = RowStore::BLOCK_ROWS;
+
+    //  ,     first_row.
+    void rebuild(const RowStore& rows, size_t first_row = 0);
+    //   [first_row, rows.size()),    .
+    void append(const RowStore& rows, size_t first_row);
+    //     (UPDATE):   .
+    void widen(size_t row, size_t column, const Value& value);
+
+    size_t block_count() const { return blocks.size(); }
+    //    UPDATE     :   .
+    bool is_widened() const { return widened; }
+    // ,     ,  .
+    std::vector<bool> candidate_blocks(const Condition& condition, const std::vector<std::string>& columns) const;
+    //     .
+    size_t memory_bytes() const;
+
+    void save(ByteWriter& out) const;
+    // false,        (  rebuild).
+    bool load(ByteReader& in, size_t row_count, size_t column_count);
+
+private:
+    std::vector<BlockZone> blocks;
+    size_t covered_rows = 0;
+    bool widened = false;
+
+    void seal(const RowStore& rows, size_t block);
+};
+
+#endif // ZONE_MAP_H